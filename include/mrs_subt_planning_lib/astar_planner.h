@@ -12,7 +12,19 @@
 #include <unordered_set>
 #include <visualization_msgs/MarkerArray.h>
 #include <iostream>
+#include <random>
+#include <deque>
+#include <array>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <Eigen/Dense>
 #include "mrs_subt_planning_lib/pcl_map.h"
+#include "mrs_subt_planning_lib/perf_counters.h"
+#include "mrs_subt_planning_lib/latency_histogram.h"
+#include "mrs_subt_planning_lib/session_recorder.h"
+#include "mrs_subt_planning_lib/submap_collection.h"
 
 
 namespace mrs_subt_planning
@@ -38,21 +50,22 @@ struct Node
   octomap::OcTreeKey key;
   octomap::point3d   pose = octomap::point3d(0.0, 0.0, 0.0);
   octomap::OcTreeKey parent_key;
-  double             g_cost      = 0;  // overall node cost
-  double             h_cost      = 0;  // heuristic cost
-  double             f_cost      = 0;  // cost from start
-  double             unnorm_cost = 0;  // cost unnormalized
-  double             obs_cost    = 0;  // cost unnormalized
-  double             path_cost   = 0;  // cost unnormalized
-  int                n_nodes     = 0;  // number of nodes visited from start
+  double             g_cost       = 0;  // overall node cost
+  double             h_cost       = 0;  // heuristic cost
+  double             f_cost       = 0;  // cost from start
+  double             unnorm_cost  = 0;  // cost unnormalized
+  double             obs_cost     = 0;  // cost unnormalized
+  double             path_cost    = 0;  // cost unnormalized
+  int                n_nodes      = 0;  // number of nodes visited from start
+  int                vertical_dir = 0;  // sign of the last vertical move, nonzero only with vertical oscillation penalty
 
   bool operator==(Node b) {
-    return key == b.key;
+    return key == b.key && vertical_dir == b.vertical_dir;
   }
 
 
   bool operator!=(const Node b) {
-    return key != b.key;
+    return key != b.key || vertical_dir != b.vertical_dir;
   }
 
   bool operator<(Node b) {
@@ -66,6 +79,118 @@ struct Node
   }
 };
 
+struct RrtNode
+{
+  octomap::point3d pose;
+  int              parent = -1;  // index of parent in the tree, -1 for root
+  double           cost   = 0;   // cost from start [m]
+  std::vector<int> children;
+};
+
+struct MotionPrimitive
+{
+  int                                start_heading;  // index of heading, multiples of 45 deg
+  int                                end_heading;
+  std::array<int, 3>                 end_offset;     // [cells]
+  double                             cost;           // length of the primitive [cells]
+  std::vector<std::array<int8_t, 3>> swept_offsets;  // voxels swept by the primitive relative to the start voxel, without the start voxel
+  std::vector<std::array<float, 3>>  samples;        // points along the primitive relative to the start voxel [cells], used for the output path
+};
+
+struct LatticeNode
+{
+  octomap::OcTreeKey key;
+  int                heading;
+  double             g_cost    = 0;   // cost from start [cells]
+  int                parent    = -1;  // index of the parent lattice node
+  int                primitive = -1;  // index of the primitive leading from the parent
+  bool               closed    = false;
+};
+
+struct CorridorBox
+{
+  octomap::point3d min;  // corners aligned with the grid
+  octomap::point3d max;
+};
+
+struct CachedPlan
+{
+  octomap::point3d  start;
+  octomap::point3d  goal;
+  uint64_t          map_revision;  // revision of the map the plan was found in
+  std::vector<Node> node_path;
+};
+
+struct LayeredNode
+{
+  octomap::OcTreeKey key;
+  int                layer;       // index of altitude layer, -1 for the start node
+  int                ground;      // z coordinate of the ground key below the node
+  double             g_cost = 0;  // cost from start [cells]
+  int                parent = -1;
+  bool               closed = false;
+};
+
+struct ConnectionCandidates
+{
+  std::array<std::array<octomap::OcTreeKey, 2>, 125> waypoints;   // candidate sequences of cells connecting two keys
+  int                                                 size   = 0;  // number of candidates
+  int                                                 length = 0;  // number of cells in every candidate (1 or 2)
+};
+
+enum class PlanningEngine
+{
+  ASTAR,              // grid A* over the octree keys (default)
+  INFORMED_RRT_STAR,  // sampling-based planner for large open spaces, the path is not postprocessed
+  STATE_LATTICE,      // A* over precomputed motion primitives, the path is not postprocessed to keep it dynamically feasible
+  LAYERED,            // 2.5D search in ground-relative altitude layers, falls back to grid A* if the goal is not reachable in the layers
+};
+
+enum class PlanningStage
+{
+  EXTRACTION,      // obstacle points from the octree
+  INDEX_BUILD,     // KD-tree build
+  SEARCH,          // grid A* search loop
+  POSTPROCESSING,  // postprocessPath()
+  COUNT,
+};
+
+enum class QueryType
+{
+  SINGLE,          // getNodePath() from start to goal
+  MULTI_WAYPOINT,  // getNodePath() through initial waypoints
+  REPAIR,          // getSafePath()
+  VALIDITY_CHECK,  // firstUnfeasibleNodeInPath()
+  COUNT,
+};
+
+struct PlanningStats
+{
+  int    iterations          = 0;
+  size_t peak_search_memory  = 0;      // [B], estimated peak size of the open list, closed list and parent map
+  int    memory_budget_hits  = 0;      // number of times the open list was pruned due to the memory budget
+  double final_admissibility = 1.0;    // heuristic weight at the end of the search, raised by the memory budget hits up to the max admissibility
+  double planning_time       = 0.0;    // [s]
+  bool   goal_reached        = false;  // false if the path leads to the nearest node found
+  double expansion_rate      = 0.0;    // [1/s], expanded nodes per second of search
+  double latency_p95         = 0.0;    // [s], 95th percentile of planning time over recent searches, 0 if latency target is disabled
+  double tuned_admissibility = 1.0;    // heuristic weight chosen by the latency controller for the next search
+  int    start_candidate     = -1;     // index of the start candidate the path starts from, -1 for a single start
+  int    informed_pruned     = 0;      // number of successors outside the informed region of the cost upper bound
+
+  // hardware counters of the planning stages, valid only if enabled by setPerfCounters()
+  PerfCounterValues extraction_counters;      // obstacle points from the octree
+  PerfCounterValues index_build_counters;     // KD-tree build
+  PerfCounterValues search_counters;          // A* search loop
+  PerfCounterValues postprocessing_counters;  // postprocessPath()
+};
+
+struct StartCandidate
+{
+  octomap::point3d pose;                // e.g. predicted pose of the vehicle along its current trajectory at the time the planning ends
+  double           initial_cost = 0.0;  // [m], added to the cost of the paths starting from this candidate
+};
+
 struct NodeCompare
 {
   bool operator()(const Node& lhs, const Node& rhs) {
@@ -79,14 +204,14 @@ inline bool operator<(const Node& lhs, const Node& rhs) {
 }
 
 inline bool operator==(const Node& lhs, const Node& rhs) {
-  return lhs.key == rhs.key;
+  return lhs.key == rhs.key && lhs.vertical_dir == rhs.vertical_dir;
 }
 
 struct NodeHasher
 {
   std::size_t operator()(const Node& n) const {
     using std::hash;
-    return ((hash<int>()(n.key.k[0]) ^ (hash<int>()(n.key.k[1]) << 1)) >> 1) ^ (hash<int>()(n.key.k[2]) << 1);
+    return (((hash<int>()(n.key.k[0]) ^ (hash<int>()(n.key.k[1]) << 1)) >> 1) ^ (hash<int>()(n.key.k[2]) << 1)) + n.vertical_dir;
   }
 };
 
@@ -107,6 +232,18 @@ public:
     }
   }
 
+  std::vector<Node> truncate(size_t max_size) {  // keeps max_size nodes with the lowest total cost, returns the removed nodes
+    std::vector<Node> removed;
+    if (this->c.size() <= max_size) {
+      return removed;
+    }
+    std::sort(this->c.begin(), this->c.end(), [this](const Node& a, const Node& b) { return this->comp(b, a); });
+    removed.assign(this->c.begin() + max_size, this->c.end());
+    this->c.resize(max_size);
+    std::make_heap(this->c.begin(), this->c.end(), this->comp);
+    return removed;
+  }
+
   std::vector<octomap::point3d> getAllNodes() {
     std::vector<octomap::point3d> nodes;
     for (auto p : this->c) {
@@ -152,15 +289,46 @@ public:
 
   std::vector<Node> getNodePath();  // for backward compatibility only
   std::vector<Node> getNodePath(const octomap::point3d& start_point, const octomap::point3d& goal_point, std::shared_ptr<octomap::OcTree> planning_octree,
-                                bool ignore_unknown_cells_near_start = false, double box_size_for_unknown_cells_replacement = 2.0);
+                                bool ignore_unknown_cells_near_start = false, double box_size_for_unknown_cells_replacement = 2.0,
+                                double cost_upper_bound = -1.0);  // negative cost_upper_bound disables informed pruning
   std::vector<Node> getNodePath(const std::vector<octomap::point3d>& initial_waypoints, std::shared_ptr<octomap::OcTree> planning_octree,
                                 bool ignore_unknown_cells_near_start = false, double box_size_for_unknown_cells_replacement = 2.0);
+  std::vector<Node> getNodePath(const octomap::point3d& start_point, const octomap::point3d& goal_point, std::shared_ptr<octomap::OcTree> planning_octree,
+                                const PCLMap& prepared_map);  // search in a map prepared in advance by getPreparedMap()
+  std::vector<Node> getNodePath(const std::vector<StartCandidate>& start_candidates, const octomap::point3d& goal_point,
+                                std::shared_ptr<octomap::OcTree> planning_octree);  // multi-source search, the path starts at the best reachable candidate
+
+  PCLMap getPreparedMap(std::shared_ptr<octomap::OcTree> planning_octree);  // obstacle index used by the search, can be built in another thread
+
+  std::vector<Node> getInformedRrtStarPath(const octomap::point3d& start_point, const octomap::point3d& goal_point,
+                                           std::shared_ptr<octomap::OcTree> planning_octree, bool ignore_unknown_cells_near_start = false,
+                                           double box_size_for_unknown_cells_replacement = 2.0);
+
+  std::vector<Node> getLayeredNodePath(const octomap::point3d& start_point, const octomap::point3d& goal_point,
+                                       std::shared_ptr<octomap::OcTree> planning_octree);
+
+  std::vector<Node> getLatticeNodePath(const octomap::point3d& start_point, const octomap::point3d& goal_point,
+                                       std::shared_ptr<octomap::OcTree> planning_octree,
+                                       double start_yaw = std::numeric_limits<double>::quiet_NaN());  // NaN start_yaw allows any start heading
+
+  // path in the world frame across submap boundaries, clearance maps are built only for submaps reached by the search
+  std::vector<octomap::point3d> getSubmapPath(const octomap::point3d& start_point, const octomap::point3d& goal_point, SubmapCollection& submaps);
+
+  // path costs [m] between all pairs of points, unreachable pairs have DBL_MAX cost, paths are returned only if requested
+  std::pair<std::vector<std::vector<double>>, std::vector<std::vector<std::vector<octomap::point3d>>>> computeCostMatrix(
+      const std::vector<octomap::point3d>& points, std::shared_ptr<octomap::OcTree> planning_octree, bool return_paths = false);
+
+  // plans toward the ranked goals in background threads with low priority, found plans are stored in the plan cache
+  void startSpeculativePlanning(const octomap::point3d& start_point, const std::vector<octomap::point3d>& goals,
+                                std::shared_ptr<octomap::OcTree> planning_octree);
+  void stopSpeculativePlanning();
+  bool getSpeculativePlan(const octomap::point3d& start_point, const octomap::point3d& goal_point, std::vector<Node>& node_path);
 
   std::vector<octomap::point3d>   getWaypointPath(const std::vector<Node>& node_path);
   std::vector<octomap::point3d>   getWaypointPath(const std::vector<octomap::OcTreeKey>& key_path);
   std::vector<octomap::point3d>   getLocalPath(const std::vector<Node>& node_path);
   std::vector<octomap::OcTreeKey> getSafePath(const std::vector<octomap::OcTreeKey>& key_path, double safe_dist, int max_iteration, double z_diff_tolerance,
-                                              bool fix_goal_point, bool horizontal_neighbors_only);
+                                              bool fix_goal_point, bool horizontal_neighbors_only, bool filter_zigzags = true);
   std::vector<octomap::point3d>   getStraightenWaypointPath(std::vector<Node>& node_path, double dist_step);
   std::vector<octomap::OcTreeKey> getFilteredPlan(const std::vector<octomap::OcTreeKey>& original_path, int size_of_window, double enabled_filtering_dist);
 
@@ -168,11 +336,42 @@ public:
                                                 int n_points_forward, const octomap::point3d& current_pose, double safe_dist_for_replanning_,
                                                 double critical_dist_for_replanning);
   octomap::point3d    getLastFoundGoal();
+  std::vector<CorridorBox> getLastCorridor();  // boxes around segments of the last postprocessed path, empty if corridor generation is disabled
+  PlanningStats       getLastPlanningStats();  // stats of the last grid A* search
+
+  // wall-clock latency histograms accumulated since construction or the last reset, e.g. over a whole mission
+  LatencyHistogram& getStageLatencyHistogram(const PlanningStage stage);
+  LatencyHistogram& getQueryLatencyHistogram(const QueryType query_type);
+  void              resetLatencyHistograms();
+  std::string       getLatencyReport(const bool json = false);  // one line per histogram, or a single JSON object
+
+  // every findPath() request is logged with the planner configuration for offline replay until stopped, the map is snapshot only when the octree object or the
+  // revision set by setMapRevision() changes, so callers updating the octree in place must set a new revision after each update, the snapshot is serialized
+  // on the calling thread and delays the request that takes it, the recorded latency does not include it
+  bool startSessionRecording(const std::string& filename);
+  void stopSessionRecording();
+
+  double              getPathCostBound(const std::vector<octomap::point3d>& previous_path, std::shared_ptr<octomap::OcTree> planning_octree);
   std::vector<octomap::OcTreeKey> getKeyPath(const std::vector<Node>& plan);
   void                            setStartAndGoal(octomap::point3d start_pose, octomap::point3d goal_pose);
   void                            setVerbose(const bool verbose);
   void                            setSafeDist(const double safe_dist);
   void                            setAstarAdmissibility(const double astar_admissibility);
+  void                            setLazyCollisionChecking(const bool lazy_collision_checking);
+  void                            setSamplingPlannerParams(const double step_size, const double goal_bias, const int max_iterations);
+  void                            setLatticeParams(const int straight_primitive_length, const double goal_tolerance);
+  void                            setCorridorGeneration(const bool enable, const double max_box_size, const double obstacle_margin = 0.0);
+  void                            setVerticalOscillationPenalty(const double penalty);  // soft cost in the grid A* only, zigzags are still possible if cheaper
+  void                            setObstacleDecimation(const double voxel_size, const double corridor_width);  // voxel_size <= 0 disables decimation
+  void                            setUnknownSpaceTraversal(const bool enable, const double cost_factor);  // cost_factor >= 1 multiplies moves into unknown cells
+  void                            setSearchMemoryBudget(const size_t max_bytes, const double max_admissibility = 2.0);  // 0 for unlimited, bound of the raised weight
+  void                            setPerfCounters(const bool enable);  // hardware counters of the planning stages in the stats
+  void                            setLatencyTarget(const double target_p95, const double max_admissibility, const int window_size);  // target <= 0 disables
+  void                            setLayeredPlanningParams(const std::vector<double>& layer_heights, const double max_ground_dist);
+  void                            setSpeculativePlanningParams(const int max_threads, const double start_tolerance, const int cache_size);
+  void                            setMapRevision(const uint64_t map_revision);
+  void                            setSensorOverlayParams(const double voxel_size, const double lifetime, const double max_query_dist);
+  void                            insertSensorPoints(const std::vector<pcl::PointXYZ>& points, const ros::Time& stamp);  // thread safe
   void                            setPlanningOctree(std::shared_ptr<octomap::OcTree> new_map);
 
   std::pair<std::vector<octomap::point3d>, bool> findPath(const octomap::point3d& start_point, const octomap::point3d& goal_point,
@@ -181,7 +380,14 @@ public:
                                                           int postprocessing_max_iterations, bool postprocessing_horizontal_neighbors_only,
                                                           double postprocessing_z_tolerance, int shortening_window_size, double shortening_dist,
                                                           bool apply_pruning, double pruning_dist, bool ignore_unknown_cells_near_start = false,
-                                                          double box_size_for_unknown_cells_replacement = 2.0);
+                                                          double box_size_for_unknown_cells_replacement = 2.0, double cost_upper_bound = -1.0,
+                                                          PlanningEngine planning_engine = PlanningEngine::ASTAR);
+
+  std::vector<octomap::point3d> postprocessPath(const std::vector<Node>& node_path, std::shared_ptr<octomap::OcTree> planning_octree, bool make_path_straight,
+                                                bool apply_postprocessing, double postprocessing_safe_dist, int postprocessing_max_iterations,
+                                                bool postprocessing_horizontal_neighbors_only, double postprocessing_z_tolerance, int shortening_window_size,
+                                                double shortening_dist, bool apply_pruning, double pruning_dist,
+                                                PlanningEngine planning_engine = PlanningEngine::ASTAR);
 
   octomap::OcTreeNode* touchNode(std::shared_ptr<octomap::OcTree>& octree, const octomap::OcTreeKey& key, unsigned int target_depth = 0);
 
@@ -224,10 +430,37 @@ protected:
   std::vector<octomap::OcTreeKey> getKeyNeighborhood8(const octomap::OcTreeKey& k);
   std::vector<octomap::OcTreeKey> getKeyNeighborhood26(const octomap::OcTreeKey& k);
   double                          nodeDistance(const Node& a, const Node& b);
+  bool                            isInInformedRegion(const octomap::point3d& p, double inflation);
+  bool                            isSegmentCollisionFree(const octomap::point3d& a, const octomap::point3d& b);
+  octomap::point3d                sampleInformedRegion(const Eigen::Matrix3d& rotation, const Eigen::Vector3d& center, double c_min, double c_best);
+  void                            updateRrtSubtreeCost(std::vector<RrtNode>& tree, int idx, double cost_diff);
+  void                            initializeMotionPrimitives();
+  MotionPrimitive                 generateMotionPrimitive(int start_heading, int end_heading, const std::array<int, 3>& end_offset);
+  bool                            isMotionPrimitiveFeasible(const octomap::OcTreeKey& start, const MotionPrimitive& primitive);
+  void                            computeCostMatrixRow(const std::vector<octomap::OcTreeKey>& keys, int source_idx, std::vector<std::vector<double>>& costs,
+                                                       std::vector<std::vector<std::vector<octomap::point3d>>>& paths, bool return_paths);
+  bool                            checkValidityForCostMatrix(const octomap::OcTreeKey& k, const std::vector<octomap::OcTreeKey>& keys);
+  void                            initializeGridParams(std::shared_ptr<octomap::OcTree> planning_octree);
+  std::vector<CorridorBox>        generateCorridor(const std::vector<octomap::point3d>& waypoints);
+  bool                            isCorridorBoxFree(const CorridorBox& box, PCLMap& corridor_map);
+  CorridorBox                     growCorridorBox(const CorridorBox& seed, PCLMap& corridor_map);
+  int                             getGroundLevel(const octomap::OcTreeKey& column, int ref_z, int max_up, int max_down);
+  bool                            isVerticalSegmentValid(const octomap::OcTreeKey& key, int z_to);
+  void                            updateLatencyController(const PlanningStats& stats);
+  void                            speculativePlanningLoop(std::shared_ptr<AstarPlanner> planner, octomap::point3d start_point,
+                                                          std::shared_ptr<octomap::OcTree> planning_octree, uint64_t map_revision, double start_tolerance,
+                                                          int cache_size);
+  void                            copySearchSettings(AstarPlanner& planner);  // configuration of the grid A* search, including initialize() params
+  bool                            findCachedPlan(const octomap::point3d& start_point, const octomap::point3d& goal_point, uint64_t map_revision,
+                                                 double start_tolerance, std::vector<Node>& node_path);
+  bool                            isUnknownCellTraversable(const octomap::OcTreeKey& k);
   bool                            checkValidityWithNeighborhood(const Node& a);
   bool                            checkValidityWithNeighborhood(const octomap::OcTreeKey& k);
   std::vector<pcl::PointXYZ>      octomapToPointcloud(const std::vector<int>& map_limits);
   std::vector<pcl::PointXYZ>      octomapToPointcloud();
+  std::vector<pcl::PointXYZ>      octomapToPointcloud(const octomap::point3d& bbx_min, const octomap::point3d& bbx_max);  // occupied cells in the box
+  void                            initObstacleMap(std::vector<pcl::PointXYZ>& pcl_points);
+  std::vector<pcl::PointXYZ>      decimateObstaclePoints(std::vector<pcl::PointXYZ>& points);  // removes the decimated points, returns their representatives
   std::vector<int>                getMapLimits(const std::vector<octomap::OcTreeKey>& plan, int start_index, int end_index, int xy_reserve, int z_reserve);
   bool                            checkLimits(const std::vector<int>& map_limits, const Node& n);
   bool                            isNodeInTheNeighborhood(const octomap::OcTreeKey& n, const octomap::OcTreeKey& center, double dist);
@@ -244,9 +477,9 @@ protected:
   int                             nofDifferentKeyCoordinates(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2);
   std::vector<octomap::OcTreeKey> getAdditionalWaypoints(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2);
   std::vector<int>                getDifferenceInCoordinates(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2);
-  std::vector<std::vector<octomap::OcTreeKey>> getPossibleWaypointsForTwoDiffCoord(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2);
-  std::vector<std::vector<octomap::OcTreeKey>> getPossibleWaypointsForThreeDiffCoord(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2);
-  std::vector<octomap::OcTreeKey>              getSafestWaypointsBetweenKeys(const std::vector<std::vector<octomap::OcTreeKey>>& possible_waypoints);
+  void                                         getPossibleWaypointsForTwoDiffCoord(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2, ConnectionCandidates& result);
+  void                                         getPossibleWaypointsForThreeDiffCoord(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2, ConnectionCandidates& result);
+  int                                          getSafestConnectionCandidate(const ConnectionCandidates& candidates);  // index of the candidate with the largest clearance
   std::vector<octomap::OcTreeKey>              getStraightenKeyPath(const std::vector<octomap::OcTreeKey>& key_path);
   bool                                         areKeysDiagonalNeighbors(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2);
   std::vector<octomap::OcTreeKey>              getSmoothPath(const std::vector<octomap::OcTreeKey>& path);
@@ -279,6 +512,81 @@ protected:
   double min_altitude_;
   double max_altitude_;
   bool   break_at_timeout_;
+  bool   lazy_collision_checking_;  // validate successors when popped from the open list instead of when generated
+  double cost_upper_bound_;         // [m], upper bound on the path cost used for informed pruning, negative if not used
+  double vertical_oscillation_penalty_;  // [m], cost of reversing the vertical direction of the path, zero disables it
+
+  std::vector<StartCandidate> start_candidates_;  // seeds of the multi-source search, empty for a single start
+
+  // sampling-based planning
+  double       rrt_step_size_;  // [m]
+  double       rrt_goal_bias_;  // probability of sampling the goal before the first solution is found
+  int          rrt_max_iterations_;
+  std::mt19937 random_generator_;  // fixed seed, results are repeatable for the same sequence of requests
+
+  // state lattice planning
+  std::vector<std::vector<MotionPrimitive>> motion_primitives_;  // motion primitives indexed by start heading
+  int                                       lattice_straight_length_;  // [cells]
+  double                                    lattice_goal_tolerance_;   // [cells]
+  std::vector<pcl::PointXYZ>                primitive_points_;         // buffer for batched clearance check of swept voxels
+
+  // layered planning
+  std::vector<double> layer_heights_;            // [m], heights of altitude layers above ground in ascending order
+  double              layered_max_ground_dist_;  // [m], max distance of start and goal above ground
+
+  // safe flight corridor
+  bool                     corridor_generation_;
+  double                   corridor_max_box_size_;     // [m], max edge length of a box
+  double                   corridor_obstacle_margin_;  // [m], min distance of the box cells from obstacles
+  std::vector<CorridorBox> last_corridor_;
+
+  // obstacle decimation, obstacles far from the start-goal segment are represented by centers of coarse voxels
+  double obstacle_decimation_voxel_size_;      // [m], 0 for full resolution everywhere
+  double obstacle_decimation_corridor_width_;  // [m], obstacles closer to the start-goal segment are kept in full resolution
+
+  // memory budget of the open list of the grid A*, on each hit the heuristic weight is doubled up to search_memory_max_admissibility_ and the worse half of
+  // the open list is dropped, the search stops with the best partial path when the closed list alone exceeds the budget
+  size_t        search_memory_budget_;             // [B], 0 for unlimited
+  double        search_memory_max_admissibility_;  // never lowers the weight below the configured admissibility
+  PlanningStats last_planning_stats_;
+
+  PerfCounters perf_counters_;  // open only if enabled, count the planning thread
+
+  std::array<LatencyHistogram, size_t(PlanningStage::COUNT)> stage_latency_;
+  std::array<LatencyHistogram, size_t(QueryType::COUNT)>     query_latency_;
+
+  SessionRecorder session_recorder_;
+
+  // latency controller, heuristic weight is adapted between astar_admissibility_ and latency_max_admissibility_ to meet the p95 target
+  double             latency_target_;             // [s], 0 for disabled
+  double             latency_max_admissibility_;  // bound of the path length inflation of weighted A*
+  int                latency_window_size_;
+  std::deque<double> latency_window_;  // [s], planning times since the last change of the weight
+  double             tuned_admissibility_;
+  double             last_latency_p95_;
+
+  // unknown space traversal, unknown cells are free at higher cost and only occupied cells are obstacles
+  bool   unknown_space_traversal_;
+  double unknown_cost_factor_;
+
+  // speculative planning
+  int                           speculative_max_threads_;
+  double                        speculative_start_tolerance_;  // [m], max distance of the current start from the start of a cached plan
+  int                           plan_cache_size_;
+  std::atomic<uint64_t>         map_revision_;
+  std::atomic<bool>             abort_speculative_planning_;
+  const std::atomic<bool>*      abort_planning_ = nullptr;  // set for planners running in speculative planning threads
+  std::vector<octomap::point3d> speculative_goals_;
+  std::atomic<int>              speculative_goal_idx_;
+  std::vector<std::thread>      speculative_workers_;
+  std::vector<CachedPlan>       plan_cache_;
+  std::mutex                    plan_cache_mutex_;
+
+  std::shared_ptr<SensorOverlay> sensor_overlay_;  // fresh obstacles from sensor scans, merged at the start of each planning or path check
+
+  OcTreeLookupCache octree_lookup_cache_;  // leaf lookups of planning_octree_, cleared at the start of every public query and whenever the octree is modified
+
+  bool map_prepared_;  // pcl_map_ was set from a map prepared in advance, the search does not build it
 
   // pruning
   std::vector<int>                           idxs_diagonal_conditioned_;
@@ -288,22 +596,14 @@ protected:
   std::vector<std::vector<std::vector<int>>> obs_diagonal_cond_;
   std::vector<std::vector<std::vector<int>>> obs_2d_diagonal_cond_;
   std::vector<std::vector<int>>              neighborhood_cube_;
-  std::vector<int>                           idxs1d;
-  std::vector<int>                           idxs2d;
-  std::vector<int>                           idxs3d;
-  std::vector<std::vector<int>>              idxs1;
-  std::vector<std::vector<int>>              idxs2;
-  std::vector<std::vector<int>>              idxs3;
-  std::vector<std::vector<int>>              idxs4;
 
   void                                       initializeIdxsOfcellsForPruning();
   std::vector<std::vector<std::vector<int>>> getObstacleConditionsForDiagonalMove();
   std::vector<std::vector<std::vector<int>>> getObstacleConditionsFor2dDiagonalMove();
   std::vector<std::vector<int>>              getCubeForMoves();
   std::vector<Node>                          getPossibleSuccessors(const octomap::OcTreeKey& parent, const octomap::OcTreeKey& current);
-  octomap::OcTreeKey                         getSafestWaypointsBetweenKeys(const std::vector<octomap::OcTreeKey>& possible_waypoints);
   octomap::OcTreeKey                         getConnectionNode3d(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2);
-  std::vector<octomap::OcTreeKey>            getAdditionalWaypoints3d(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2);
+  std::array<octomap::OcTreeKey, 2>          getAdditionalWaypoints3d(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2);
   octomap::OcTreeKey                         getBestNeighborEscape(const octomap::OcTreeKey& c, const octomap::OcTreeKey& prev);
   std::vector<octomap::OcTreeKey>            getFilteredNeighborhoodPlan(const std::vector<octomap::OcTreeKey>& plan);
   bool                                       areKeysInTwoStepsDistance(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2);
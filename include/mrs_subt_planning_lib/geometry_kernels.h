@@ -0,0 +1,29 @@
+#ifndef __GEOMETRY_KERNELS_H__
+#define __GEOMETRY_KERNELS_H__
+
+#include <cstddef>
+#include <pcl/point_types.h>
+
+// hot loops are built in several ISA variants, the variant is selected at load time by CPUID (GCC/Clang function multiversioning on x86-64)
+#if defined(MRS_SUBT_PLANNING_TARGET_CLONES) && defined(__x86_64__) && defined(__GNUC__)
+#define MRS_SUBT_PLANNING_MULTIVERSIONED __attribute__((target_clones("avx512f", "avx2", "sse4.2", "default")))
+#else
+#define MRS_SUBT_PLANNING_MULTIVERSIONED
+#endif
+
+namespace mrs_subt_planning
+{
+
+/**
+ * @brief minimum of the squared distances of the points to the query point and of max_sqr_dist
+ */
+float getMinSquaredDistance(const pcl::PointXYZ* points, size_t n_points, const pcl::PointXYZ& query, float max_sqr_dist);
+
+/**
+ * @brief distances[i] is the distance of points[i] to the segment from start to end, distances must have at least n_points elements
+ */
+void getDistancesToSegment(const pcl::PointXYZ* points, size_t n_points, const pcl::PointXYZ& start, const pcl::PointXYZ& end, float* distances);
+
+}  // namespace mrs_subt_planning
+
+#endif
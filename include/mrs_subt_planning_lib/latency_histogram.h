@@ -0,0 +1,50 @@
+#ifndef __LATENCY_HISTOGRAM_H__
+#define __LATENCY_HISTOGRAM_H__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace mrs_subt_planning
+{
+
+/**
+ * @brief Histogram of latencies with log-linear buckets (16 buckets per power of two of microseconds, relative error below 6.25 %).
+ *
+ * Recording is lock-free and can be called from any thread. Reading concurrently with recording returns a consistent enough snapshot for reporting, reset()
+ * concurrent with recording may lose the concurrently recorded samples.
+ */
+class LatencyHistogram {
+public:
+  LatencyHistogram();
+
+  void record(double latency);  // [s]
+  void reset();
+
+  uint64_t getCount() const;
+  double   getMean() const;                         // [s]
+  double   getMax() const;                          // [s]
+  double   getPercentile(double percentile) const;  // [s], percentile in [0, 100], 0 for empty histogram
+
+  std::string toString() const;  // "n=... mean=... p50=... p90=... p99=... p99.9=... max=..." in ms
+  std::string toJson() const;    // the same values as a JSON object
+
+private:
+  static constexpr int SUB_BUCKET_BITS = 4;                     // 16 buckets per power of two
+  static constexpr int MAX_BITS        = 38;                    // latencies up to 2^38 us (76 hours)
+  static constexpr int N_LINEAR        = 2 << SUB_BUCKET_BITS;  // values below are stored exactly
+  static constexpr int N_BUCKETS       = N_LINEAR + (MAX_BITS - SUB_BUCKET_BITS - 1) * (1 << SUB_BUCKET_BITS);
+
+  static int      bucketIndex(uint64_t value);
+  static uint64_t bucketMidpoint(int index);
+
+  std::array<std::atomic<uint64_t>, N_BUCKETS> buckets_;
+  std::atomic<uint64_t>                        count_;
+  std::atomic<uint64_t>                        sum_;  // [us]
+  std::atomic<uint64_t>                        max_;  // [us]
+};
+
+}  // namespace mrs_subt_planning
+
+#endif
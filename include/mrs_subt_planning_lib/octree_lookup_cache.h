@@ -0,0 +1,46 @@
+#ifndef __OCTREE_LOOKUP_CACHE_H__
+#define __OCTREE_LOOKUP_CACHE_H__
+
+#include <array>
+#include <octomap/OcTree.h>
+
+namespace mrs_subt_planning
+{
+
+/**
+ * @brief Replacement of OcTree::search(key) which remembers the last few leaves with their extents in the key space.
+ *
+ * Pruned octrees contain large homogeneous leaves, so consecutive queries often land in the same leaf and are answered without a descent from the root.
+ * Unknown regions (missing children) are remembered in the same way. The cache must be cleared whenever the octree is modified and it must not be shared
+ * between threads.
+ */
+class OcTreeLookupCache {
+public:
+  OcTreeLookupCache();
+
+  octomap::OcTreeNode* search(const octomap::OcTree* octree, const octomap::OcTreeKey& key);  // same result as octree->search(key)
+  void                 clear();
+
+  uint64_t getNumberOfHits();
+  uint64_t getNumberOfMisses();
+
+private:
+  struct Entry
+  {
+    octomap::OcTreeKey   min;       // first key covered by the leaf
+    unsigned int         size = 0;  // number of keys covered by the leaf along each axis
+    octomap::OcTreeNode* node = NULL;  // NULL for unknown region
+  };
+
+  static constexpr int CAPACITY = 4;
+
+  const octomap::OcTree*      octree_;
+  std::array<Entry, CAPACITY> entries_;
+  int                         next_entry_;  // entry replaced by the next miss
+  uint64_t                    hits_;
+  uint64_t                    misses_;
+};
+
+}  // namespace mrs_subt_planning
+
+#endif
@@ -4,6 +4,10 @@
 #include <vector>
 #include <string.h>
 #include <iostream>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <ros/time.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
@@ -12,10 +16,59 @@
 #include <pcl/kdtree/kdtree_flann.h>
 #include <octomap_msgs/conversions.h>
 #include <octomap_msgs/Octomap.h>
+#include "mrs_subt_planning_lib/octree_lookup_cache.h"
 
 namespace mrs_subt_planning
 {
 
+/**
+ * @brief Short-lived obstacle points inserted directly from sensor scans, deduplicated in voxels and removed after their lifetime
+ */
+class SensorOverlay {
+public:
+  SensorOverlay(double voxel_size = 0.2, double lifetime = 1.0, double max_query_dist = 2.0);
+
+  void setParams(double voxel_size, double lifetime, double max_query_dist);
+
+  /**
+   * @brief stores points in a buffer, can be called from any thread, the points become visible after the next update()
+   */
+  void insertPoints(const std::vector<pcl::PointXYZ> &points, const ros::Time &stamp);
+
+  /**
+   * @brief merges inserted points and removes expired points, must not be called concurrently with distance queries
+   */
+  void update(const ros::Time &now);
+
+  /**
+   * @brief distance to the nearest overlay point, FLT_MAX if there is no point closer than max_query_dist
+   */
+  double getDistanceFromNearestPoint(const pcl::PointXYZ &point);
+
+  size_t size();
+  void   clear();
+
+private:
+  struct OverlayPoint
+  {
+    pcl::PointXYZ point;
+    ros::Time     stamp;
+  };
+
+  uint64_t cellId(const pcl::PointXYZ &point, double cell_size);
+  uint64_t cellId(int x, int y, int z);
+
+  double voxel_size_;
+  double lifetime_;
+  double max_query_dist_;  // size of the buckets used for queries
+
+  std::unordered_map<uint64_t, OverlayPoint>               voxels_;   // one point per voxel, the newest one
+  std::unordered_map<uint64_t, std::vector<pcl::PointXYZ>> buckets_;  // points in coarse cells of size max_query_dist_
+
+  std::vector<std::pair<pcl::PointXYZ, ros::Time>> pending_points_;
+  std::mutex                                       pending_mutex_;
+};
+
 /**
  * @brief Class PCLMap provides the loading of the map and obstacles using Point Cloud Library (PCL)
  */
@@ -62,13 +115,42 @@ public:
                                  const double allowed_angle_diff);
 
   pcl::PointCloud<pcl::PointXYZ>::Ptr getPCLCloud();
-  void                                initKDTreeSearch(pcl::PointCloud<pcl::PointXYZ>::Ptr points);
+  void                                initKDTreeSearch(pcl::PointCloud<pcl::PointXYZ>::Ptr points);  // also drops the coarse obstacles of the previous map
+  void                                initOctreeSearch(pcl::PointCloud<pcl::PointXYZ>::Ptr points);  // index of radiusSearch() and simulatedCyllinderSearch()
   double                              getDistanceFromNearestPoint(pcl::PointXYZ point);
   void                                insertPoint(pcl::PointXYZ point);
   void                                initCloud();
 
   bool checkDistanceFromNearestPoint(pcl::PointXYZ point, double safe_dist_xy, double safe_dist_z);
 
+  /**
+   * @brief batched clearance check of a set of points, stops at the first point closer than safe_dist to an obstacle
+   *
+   * @param points
+   * @param safe_dist
+   * @return true if all points are at least safe_dist from the nearest obstacle point
+   */
+  bool arePointsInSafeDistance(const std::vector<pcl::PointXYZ> &points, double safe_dist);
+
+  /**
+   * @brief batched distance query, distances[i] is the distance of points[i] to the nearest obstacle point, no allocation per call
+   *
+   * @param points
+   * @param n_points
+   * @param distances output array with at least n_points elements
+   */
+  void getDistancesFromNearestPoints(const pcl::PointXYZ *points, size_t n_points, double *distances);
+
+  /**
+   * @brief adds decimated obstacles to the map, must be called after initKDTreeSearch()
+   *
+   * @param points representatives of obstacle points, every represented point is at most max_error far from its representative
+   * @param max_error distances to the coarse points are reduced by max_error, so the distance queries never overestimate the distance to an obstacle
+   */
+  void initCoarseKDTreeSearch(pcl::PointCloud<pcl::PointXYZ>::Ptr points, double max_error);
+
+  void setSensorOverlay(std::shared_ptr<SensorOverlay> sensor_overlay);  // distance queries return the minimum of the index and the overlay
+
   static pcl::PointCloud<pcl::PointXYZ>::Ptr pclVectorToPointcloud(const std::vector<pcl::PointXYZ> &points);
 
   static pcl::PointCloud<pcl::PointXYZ>::Ptr octomapToPointcloud(std::shared_ptr<octomap::OcTree> input_octree, std::array<octomap::point3d, 2> map_limits, bool ignore_unknown_cells);
@@ -79,6 +161,12 @@ private:
   /* pcl::search::KdTree<pcl::PointXYZ>::Ptr                 kdtree; */
   pcl::KdTreeFLANN<pcl::PointXYZ>::Ptr kdtree;
   bool                                 kd_tree_initialized = false;
+  pcl::KdTreeFLANN<pcl::PointXYZ>::Ptr coarse_kdtree;
+  bool                                 coarse_kd_tree_initialized = false;
+  double                               coarse_max_error           = 0.0;
+  std::shared_ptr<SensorOverlay>       sensor_overlay_;
+
+  double getKDTreeDistance(const pcl::PointXYZ &point);  // FLT_MAX if both trees are empty
   /* pcl::octree::OctreePointCloud */
 };
 
@@ -0,0 +1,47 @@
+#ifndef __PERF_COUNTERS_H__
+#define __PERF_COUNTERS_H__
+
+#include <array>
+#include <cstdint>
+
+namespace mrs_subt_planning
+{
+
+struct PerfCounterValues
+{
+  uint64_t cycles        = 0;
+  uint64_t instructions  = 0;
+  uint64_t llc_misses    = 0;  // last level cache misses as reported by the generic cache-miss event
+  uint64_t branch_misses = 0;
+  bool     valid         = false;  // false if the counters were not open
+};
+
+/**
+ * @brief Hardware performance counters of the calling thread read through perf_event_open(), available on Linux only.
+ *
+ * The counters count only the thread that opened them, start() reopens them if it is called from another thread, so the counts always belong to the thread
+ * measuring the stage. Opening fails without permissions to the perf events (kernel.perf_event_paranoid) or in virtualized environments without the PMU.
+ */
+class PerfCounters {
+public:
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  bool open();  // returns false if the counters are not available
+  void close();
+  bool isOpen();
+
+  void              start();  // resets and enables the counters, no-op if not open
+  PerfCounterValues stop();   // disables the counters and returns the counts since start(), invalid if called from another thread than start()
+
+private:
+  std::array<int, 4> fds_;        // group leader (cycles) first
+  long               owner_tid_;  // thread counted by the open counters
+};
+
+}  // namespace mrs_subt_planning
+
+#endif
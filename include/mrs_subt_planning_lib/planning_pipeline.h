@@ -0,0 +1,140 @@
+#ifndef __PLANNING_PIPELINE_H__
+#define __PLANNING_PIPELINE_H__
+
+#include <deque>
+#include <functional>
+#include <condition_variable>
+#include "mrs_subt_planning_lib/astar_planner.h"
+
+namespace mrs_subt_planning
+{
+
+struct PlanningRequest
+{
+  uint64_t                         id = 0;  // assigned by the pipeline
+  octomap::point3d                 start;
+  octomap::point3d                 goal;
+  std::shared_ptr<octomap::OcTree> planning_octree;  // must not be modified after submission
+  ros::Time                        deadline;         // request is dropped between stages after the deadline, zero for no deadline
+
+  // postprocessing, same meaning as in AstarPlanner::findPath()
+  bool   make_path_straight                       = false;
+  bool   apply_postprocessing                     = true;
+  double postprocessing_safe_dist                 = 1.0;
+  int    postprocessing_max_iterations            = 5;
+  bool   postprocessing_horizontal_neighbors_only = false;
+  double postprocessing_z_tolerance               = 0.3;
+  int    shortening_window_size                   = 5;
+  double shortening_dist                          = 1.0;
+  bool   apply_pruning                            = true;
+  double pruning_dist                             = 0.3;
+};
+
+struct PlanningResult
+{
+  uint64_t                      id;
+  std::vector<octomap::point3d> waypoints;
+  double                        latency;  // [s], from submission to the end of postprocessing
+};
+
+/**
+ * @brief Queue with limited capacity, the oldest item is dropped when a new item does not fit.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity) : capacity_(capacity) {
+  }
+
+  bool push(T item) {  // returns false if an older item was dropped
+    std::scoped_lock lock(mutex_);
+    bool             dropped = false;
+    if (queue_.size() >= capacity_) {
+      queue_.pop_front();
+      dropped = true;
+    }
+    queue_.push_back(std::move(item));
+    condition_.notify_one();
+    return !dropped;
+  }
+
+  bool pop(T& item) {  // blocks until an item is available, returns false if the queue was closed
+    std::unique_lock lock(mutex_);
+    condition_.wait(lock, [this] { return !queue_.empty() || closed_; });
+    if (closed_) {
+      return false;
+    }
+    item = std::move(queue_.front());
+    queue_.pop_front();
+    return true;
+  }
+
+  void close() {
+    std::scoped_lock lock(mutex_);
+    closed_ = true;
+    condition_.notify_all();
+  }
+
+private:
+  size_t                  capacity_;
+  bool                    closed_ = false;
+  std::deque<T>           queue_;
+  std::mutex              mutex_;
+  std::condition_variable condition_;
+};
+
+/**
+ * @brief Planning of consecutive requests in three stages (map preparation, search, postprocessing), each stage runs in its own thread.
+ */
+class PlanningPipeline {
+public:
+  explicit PlanningPipeline(size_t queue_size = 2);
+
+  ~PlanningPipeline();
+
+  void initialize(bool enable_planning_to_unreachable_goal, double planning_timeout, double safe_dist, double clearing_dist, double min_altitude,
+                  double max_altitude, std::function<void(const PlanningResult&)> result_callback);
+
+  uint64_t submit(PlanningRequest request);  // returns id of the request
+  void     stop();
+  uint64_t getNumberOfDroppedRequests();
+
+protected:
+  struct PreparedRequest
+  {
+    PlanningRequest request;
+    ros::Time       submission_time;
+    PCLMap          prepared_map;
+  };
+
+  struct SearchedRequest
+  {
+    PlanningRequest   request;
+    ros::Time         submission_time;
+    std::vector<Node> node_path;
+  };
+
+  void prepLoop();
+  void searchLoop();
+  void postprocessLoop();
+  bool isStale(const PlanningRequest& request, const std::string& stage);
+
+  // each stage has its own planner, the planners are not shared between threads
+  AstarPlanner prep_planner_;
+  AstarPlanner search_planner_;
+  AstarPlanner postprocess_planner_;
+
+  BoundedQueue<std::pair<PlanningRequest, ros::Time>> prep_queue_;
+  BoundedQueue<PreparedRequest>                       search_queue_;
+  BoundedQueue<SearchedRequest>                       postprocess_queue_;
+
+  std::function<void(const PlanningResult&)> result_callback_;
+  std::atomic<uint64_t>                      next_id_;
+  std::atomic<uint64_t>                      dropped_requests_;
+  bool                                       initialized_;
+  std::vector<std::thread>                   stage_threads_;
+};
+
+}  // namespace mrs_subt_planning
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef __SESSION_RECORDER_H__
+#define __SESSION_RECORDER_H__
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <octomap/OcTree.h>
+
+namespace mrs_subt_planning
+{
+
+struct SessionRecord
+{
+  double stamp = 0.0;  // [s], ROS time of the request
+
+  // planner configuration, same meaning as in AstarPlanner::initialize()
+  bool   enable_planning_to_unreachable_goal = true;
+  double planning_timeout                    = 0.0;
+  double safe_dist                           = 0.0;
+  double clearing_dist                       = 0.0;
+  double min_altitude                        = 0.0;
+  double max_altitude                        = 0.0;
+  bool   break_at_timeout                    = false;
+  double astar_admissibility                 = 1.0;
+
+  // planner configuration, same meaning as the params of the AstarPlanner setters
+  bool                lazy_collision_checking            = false;
+  double              vertical_oscillation_penalty       = 0.0;
+  double              obstacle_decimation_voxel_size     = 0.0;
+  double              obstacle_decimation_corridor_width = 0.0;
+  bool                unknown_space_traversal            = false;
+  double              unknown_cost_factor                = 1.0;
+  uint64_t            search_memory_budget               = 0;
+  double              search_memory_max_admissibility    = 2.0;
+  double              rrt_step_size                      = 0.0;
+  double              rrt_goal_bias                      = 0.0;
+  int                 rrt_max_iterations                 = 0;
+  int                 lattice_straight_length            = 0;
+  double              lattice_goal_tolerance             = 0.0;
+  std::vector<double> layer_heights;
+  double              layered_max_ground_dist  = 0.0;
+  bool                corridor_generation      = false;
+  double              corridor_max_box_size    = 0.0;
+  double              corridor_obstacle_margin = 0.0;
+
+  // parameters of AstarPlanner::findPath()
+  octomap::point3d start;
+  octomap::point3d goal;
+  bool             make_path_straight                       = false;
+  bool             apply_postprocessing                     = true;
+  double           planning_bbx_size_h                      = 0.0;
+  double           planning_bbx_size_v                      = 0.0;
+  double           postprocessing_safe_dist                 = 0.0;
+  int              postprocessing_max_iterations            = 0;
+  bool             postprocessing_horizontal_neighbors_only = false;
+  double           postprocessing_z_tolerance               = 0.0;
+  int              shortening_window_size                   = 0;
+  double           shortening_dist                          = 0.0;
+  bool             apply_pruning                            = true;
+  double           pruning_dist                             = 0.0;
+  bool             ignore_unknown_cells_near_start          = false;
+  double           box_size_for_unknown_cells_replacement   = 0.0;
+  double           cost_upper_bound                         = -1.0;
+  int              planning_engine                          = 0;  // PlanningEngine
+
+  // outcome of the recorded request
+  double   latency     = 0.0;  // [s], wall time of findPath()
+  uint32_t n_waypoints = 0;
+  double   path_length = 0.0;
+
+  std::string map_data;  // octomap binary stream of the planning octree, empty if the map did not change since the previous record
+
+  bool hasSameConfig(const SessionRecord& other) const;  // true if the planner configuration of both records is equal
+};
+
+/**
+ * @brief Binary log of planning requests with snapshots of the planning octree, written by AstarPlanner::findPath() if recording is enabled.
+ *
+ * A snapshot is stored only if the octree object or the map revision changed since the previous request, the snapshot is taken before planning modifies the
+ * octree. Octrees updated in place without a new map revision are not snapshot again. Snapshots are stored in the octomap binary format, i.e. only the
+ * free/occupied state of the cells is kept.
+ */
+class SessionRecorder {
+public:
+  SessionRecorder();
+
+  bool open(const std::string& filename);  // returns false if the file cannot be created
+  void close();
+  bool isOpen();
+
+  void   beginRequest(const SessionRecord& record, std::shared_ptr<octomap::OcTree> octree, const uint64_t map_revision);
+  void   endRequest(const std::vector<octomap::point3d>& waypoints, const double latency);  // writes the record started by beginRequest()
+  size_t getNumberOfRecordedRequests();
+
+private:
+  std::ofstream                  file_;
+  SessionRecord                  pending_record_;
+  bool                           request_pending_;
+  std::weak_ptr<octomap::OcTree> last_octree_;  // does not keep the octree alive, an expired pointer counts as a changed map
+  uint64_t                       last_map_revision_;
+  size_t                         n_recorded_requests_;
+};
+
+/**
+ * @brief Sequential reader of the logs written by SessionRecorder.
+ */
+class SessionReader {
+public:
+  bool open(const std::string& filename);  // returns false if the file cannot be opened or is not a session log
+
+  // returns false at the end of the log or on a truncated record, octree is replaced only if the record contains a map snapshot
+  bool readNext(SessionRecord& record, std::shared_ptr<octomap::OcTree>& octree);
+
+private:
+  std::ifstream file_;
+};
+
+}  // namespace mrs_subt_planning
+
+#endif
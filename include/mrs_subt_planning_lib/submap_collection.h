@@ -0,0 +1,53 @@
+#ifndef __SUBMAP_COLLECTION_H__
+#define __SUBMAP_COLLECTION_H__
+
+#include <Eigen/Geometry>
+#include <octomap/OcTree.h>
+#include "mrs_subt_planning_lib/pcl_map.h"
+
+namespace mrs_subt_planning
+{
+
+enum class CellState
+{
+  UNKNOWN,
+  FREE,
+  OCCUPIED,
+};
+
+struct Submap
+{
+  std::shared_ptr<octomap::OcTree> octree;
+  Eigen::Isometry3d                pose;      // submap frame in the world frame
+  Eigen::Isometry3d                pose_inv;  // world frame in the submap frame
+  octomap::point3d                 bbx_min;   // axis aligned bounds in the world frame
+  octomap::point3d                 bbx_max;
+  std::shared_ptr<PCLMap>          clearance_map;  // occupied cells in the world frame, built when the submap is first queried
+};
+
+/**
+ * @brief Set of local maps with poses, queried in the world frame without merging the maps into a single octree
+ */
+class SubmapCollection {
+public:
+  SubmapCollection();
+
+  void   addSubmap(std::shared_ptr<octomap::OcTree> octree, const Eigen::Isometry3d& pose);  // the octree must not be modified afterwards
+  void   clear();
+  size_t size();
+  double getResolution();  // resolution of the first submap, all submaps are expected to share it
+
+  CellState getCellState(const octomap::point3d& point);  // occupied in any submap wins over free in another one
+  double    getDistanceFromNearestObstacle(const octomap::point3d& point, double max_dist);  // FLT_MAX if no obstacle closer than max_dist
+  int       getNumberOfClearanceMaps();  // number of submaps with clearance map already built
+
+protected:
+  bool isInBounds(const Submap& submap, const octomap::point3d& point, double inflation);
+  void initClearanceMap(Submap& submap);
+
+  std::vector<Submap> submaps_;
+};
+
+}  // namespace mrs_subt_planning
+
+#endif
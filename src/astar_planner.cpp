@@ -1,15 +1,80 @@
 #include "mrs_subt_planning_lib/astar_planner.h"
+#include "mrs_subt_planning_lib/geometry_kernels.h"
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <sstream>
 
 using namespace std;
 using namespace mrs_subt_planning;
 
+namespace
+{
+
+struct TwoStepOffsets
+{
+  std::array<std::array<int, 2>, 5> offsets;  // {offset of the cell next to the target, offset of the second cell from the first one}
+  int                               size;
+};
+
+struct OneStepOffsets
+{
+  std::array<int, 3> offsets;
+  int                size;
+};
+
+// candidate offsets along one axis towards the source key, indexed by the absolute difference of the keys in the axis (saturated)
+constexpr std::array<TwoStepOffsets, 4> two_step_offsets = {{{{{{-1, 0}, {0, -1}, {1, 0}, {0, 1}, {0, 0}}}, 5},
+                                                             {{{{-1, 0}, {0, -1}, {0, 0}, {-1, -1}}}, 4},
+                                                             {{{{-1, 0}, {0, -1}}}, 2},
+                                                             {{{{-1, -1}}}, 1}}};
+constexpr std::array<OneStepOffsets, 3> one_step_offsets = {{{{-1, 0, 1}, 3}, {{-1, 0}, 2}, {{-1}, 1}}};
+
+}  // namespace
+
 AstarPlanner::AstarPlanner(void) {
-  initialized_         = false;
-  verbose_             = false;
-  astar_admissibility_ = 1.0;
+  initialized_             = false;
+  verbose_                 = false;
+  astar_admissibility_     = 1.0;
+  lazy_collision_checking_ = false;
+  cost_upper_bound_        = -1.0;
+  rrt_step_size_           = 1.0;
+  rrt_goal_bias_           = 0.05;
+  rrt_max_iterations_      = 5000;
+  random_generator_.seed(0);
+  lattice_straight_length_ = 3;
+  lattice_goal_tolerance_  = 2.0;
+  initializeMotionPrimitives();
+  speculative_max_threads_     = 1;
+  speculative_start_tolerance_ = 0.5;
+  plan_cache_size_             = 10;
+  map_revision_                = 0;
+  abort_speculative_planning_  = false;
+  speculative_goal_idx_        = 0;
+  map_prepared_                = false;
+  layer_heights_               = {1.0, 2.0};
+  layered_max_ground_dist_     = 5.0;
+  vertical_oscillation_penalty_ = 0.0;
+  corridor_generation_         = false;
+  corridor_max_box_size_       = 3.0;
+  corridor_obstacle_margin_    = 0.0;
+  obstacle_decimation_voxel_size_     = 0.0;
+  unknown_space_traversal_            = false;
+  unknown_cost_factor_                = 2.0;
+  search_memory_budget_               = 0;
+  search_memory_max_admissibility_    = 2.0;
+  latency_target_                     = 0.0;
+  latency_max_admissibility_          = 2.0;
+  latency_window_size_                = 20;
+  tuned_admissibility_                = 1.0;
+  last_latency_p95_                   = 0.0;
+  obstacle_decimation_corridor_width_ = 2.0;
+  sensor_overlay_              = std::make_shared<SensorOverlay>();
+  pcl_map_.setSensorOverlay(sensor_overlay_);
 }
 
 AstarPlanner::~AstarPlanner() {
+  stopSpeculativePlanning();
 }
 
 /* initialize() //{ */
@@ -17,6 +82,7 @@ void AstarPlanner::initialize(octomap::point3d start_point, octomap::point3d goa
                               bool enable_planning_to_unreachable_goal, double planning_timeout, double safe_dist, double clearing_dist, double min_altitude,
                               double max_altitude, bool debug, std::shared_ptr<mrs_lib::BatchVisualizer> batch_visualizer, const bool break_at_timeout) {
   planning_octree_ = planning_octree;
+  octree_lookup_cache_.clear();
   start_.pose      = start_point;
   goal_.pose       = goal_point;
   planning_octree_->getMetricSize(grid_params_.width, grid_params_.height, grid_params_.depth);
@@ -71,7 +137,9 @@ bool AstarPlanner::isNodeValid(const Node& n) {
   }
   if (isNodeInTheNeighborhood(n.key, start_.key, clearing_dist_)) {  // unknown
     return true;
-  } else if (planning_octree_->search(n.key) == NULL || planning_octree_->isNodeOccupied(planning_octree_->search(n.key))) {  // occupied
+  }
+  octomap::OcTreeNode* node = octree_lookup_cache_.search(planning_octree_.get(), n.key);
+  if (node == NULL ? !isUnknownCellTraversable(n.key) : planning_octree_->isNodeOccupied(node)) {  // occupied or unknown
     return false;
   }
   /* else if (planning_octree_->search(n.key) != NULL && planning_octree_->isNodeOccupied(planning_octree_->search(n.key))) { */
@@ -82,11 +150,22 @@ bool AstarPlanner::isNodeValid(const Node& n) {
 }
 //}
 
+/* isUnknownCellTraversable() //{ */
+bool AstarPlanner::isUnknownCellTraversable(const octomap::OcTreeKey& k) {
+  if (!unknown_space_traversal_) {
+    return false;
+  }
+  // only inside the horizontal bounds of the map, otherwise the search would flood the unbounded unknown space
+  octomap::point3d p = planning_octree_->keyToCoord(k);
+  return p.x() >= grid_params_.min_x && p.x() <= grid_params_.max_x && p.y() >= grid_params_.min_y && p.y() <= grid_params_.max_y;
+}
+//}
+
 /* checkValidityWithNeighborhood() //{ */
 bool AstarPlanner::checkValidityWithNeighborhood(const Node& n) {
   if (isNodeInTheNeighborhood(n.key, start_.key, clearing_dist_)) {  // unknown
     return true;
-  } else if (planning_octree_->search(n.key) == NULL) {
+  } else if (octree_lookup_cache_.search(planning_octree_.get(), n.key) == NULL && !isUnknownCellTraversable(n.key)) {
     return false;
   }
   return checkValidityWithKDTree(n);
@@ -97,7 +176,7 @@ bool AstarPlanner::checkValidityWithNeighborhood(const Node& n) {
 bool AstarPlanner::checkValidityWithNeighborhood(const octomap::OcTreeKey& k) {
   if (isNodeInTheNeighborhood(k, start_.key, clearing_dist_)) {  // unknown
     return true;
-  } else if (planning_octree_->search(k) == NULL) {
+  } else if (octree_lookup_cache_.search(planning_octree_.get(), k) == NULL && !isUnknownCellTraversable(k)) {
     return false;
   }
   return checkValidityWithKDTree(k);
@@ -144,23 +223,141 @@ std::pair<std::vector<octomap::point3d>, bool> AstarPlanner::findPath(
     const octomap::point3d& start_point, const octomap::point3d& goal_point, std::shared_ptr<octomap::OcTree> planning_octree, bool make_path_straight,
     bool apply_postprocessing, double planning_bbx_size_h, double planning_bbx_size_v, double postprocessing_safe_dist, int postprocessing_max_iterations,
     bool postprocessing_horizontal_neighbors_only, double postprocessing_z_tolerance, int shortening_window_size, double shortening_dist, bool apply_pruning,
-    double pruning_dist, bool ignore_unknown_cells_near_start, double box_size_for_unknown_cells_replacement) {
+    double pruning_dist, bool ignore_unknown_cells_near_start, double box_size_for_unknown_cells_replacement, double cost_upper_bound,
+    PlanningEngine planning_engine) {
 
   if (make_path_straight && apply_postprocessing) {
     ROS_WARN("[%s]: The path straightening cannot be applied together with the path postprocessing. ", ros::this_node::getName().c_str());
   }
 
+  if (session_recorder_.isOpen()) {  // map snapshot has to be taken before the planning modifies the octree
+    SessionRecord record;
+    record.stamp                                    = ros::Time::now().toSec();
+    record.enable_planning_to_unreachable_goal      = enable_planning_to_unreachable_goal_;
+    record.planning_timeout                         = planning_timeout_ + 0.2;  // as passed to initialize()
+    record.safe_dist                                = safe_dist_;
+    record.clearing_dist                            = clearing_dist_;
+    record.min_altitude                             = min_altitude_;
+    record.max_altitude                             = max_altitude_;
+    record.break_at_timeout                         = break_at_timeout_;
+    record.astar_admissibility                      = latency_target_ > 0.0 ? tuned_admissibility_ : astar_admissibility_;
+    record.lazy_collision_checking                  = lazy_collision_checking_;
+    record.vertical_oscillation_penalty             = vertical_oscillation_penalty_;
+    record.obstacle_decimation_voxel_size           = obstacle_decimation_voxel_size_;
+    record.obstacle_decimation_corridor_width       = obstacle_decimation_corridor_width_;
+    record.unknown_space_traversal                  = unknown_space_traversal_;
+    record.unknown_cost_factor                      = unknown_cost_factor_;
+    record.search_memory_budget                     = search_memory_budget_;
+    record.search_memory_max_admissibility          = search_memory_max_admissibility_;
+    record.rrt_step_size                            = rrt_step_size_;
+    record.rrt_goal_bias                            = rrt_goal_bias_;
+    record.rrt_max_iterations                       = rrt_max_iterations_;
+    record.lattice_straight_length                  = lattice_straight_length_;
+    record.lattice_goal_tolerance                   = lattice_goal_tolerance_;
+    record.layer_heights                            = layer_heights_;
+    record.layered_max_ground_dist                  = layered_max_ground_dist_;
+    record.corridor_generation                      = corridor_generation_;
+    record.corridor_max_box_size                    = corridor_max_box_size_;
+    record.corridor_obstacle_margin                 = corridor_obstacle_margin_;
+    record.start                                    = start_point;
+    record.goal                                     = goal_point;
+    record.make_path_straight                       = make_path_straight;
+    record.apply_postprocessing                     = apply_postprocessing;
+    record.planning_bbx_size_h                      = planning_bbx_size_h;
+    record.planning_bbx_size_v                      = planning_bbx_size_v;
+    record.postprocessing_safe_dist                 = postprocessing_safe_dist;
+    record.postprocessing_max_iterations            = postprocessing_max_iterations;
+    record.postprocessing_horizontal_neighbors_only = postprocessing_horizontal_neighbors_only;
+    record.postprocessing_z_tolerance               = postprocessing_z_tolerance;
+    record.shortening_window_size                   = shortening_window_size;
+    record.shortening_dist                          = shortening_dist;
+    record.apply_pruning                            = apply_pruning;
+    record.pruning_dist                             = pruning_dist;
+    record.ignore_unknown_cells_near_start          = ignore_unknown_cells_near_start;
+    record.box_size_for_unknown_cells_replacement   = box_size_for_unknown_cells_replacement;
+    record.cost_upper_bound                         = cost_upper_bound;
+    record.planning_engine                          = int(planning_engine);
+    session_recorder_.beginRequest(record, planning_octree, map_revision_);
+  }
+  ros::WallTime request_start = ros::WallTime::now();  // recorded latency excludes the map snapshot, the replay does not serialize the map
+
   std::vector<double> bbx   = {planning_bbx_size_h, planning_bbx_size_h, planning_bbx_size_v};
   ros::Time           start = ros::Time::now();
   ROS_INFO("[%s]: Tree resampling took %.2f s.", ros::this_node::getName().c_str(), (ros::Time::now() - start).toSec());
-  std::vector<Node> node_path = getNodePath(start_point, goal_point, planning_octree, ignore_unknown_cells_near_start, box_size_for_unknown_cells_replacement);
+  std::vector<Node> node_path;
+  if (planning_engine == PlanningEngine::INFORMED_RRT_STAR) {
+    node_path = getInformedRrtStarPath(start_point, goal_point, planning_octree, ignore_unknown_cells_near_start, box_size_for_unknown_cells_replacement);
+  } else if (planning_engine == PlanningEngine::STATE_LATTICE) {
+    if (ignore_unknown_cells_near_start) {
+      planning_octree_ = planning_octree;
+      octree_lookup_cache_.clear();
+      replaceUnknownByFreeCells(planning_octree->coordToKey(start_point), box_size_for_unknown_cells_replacement);
+    }
+    node_path = getLatticeNodePath(start_point, goal_point, planning_octree);
+  } else if (planning_engine == PlanningEngine::LAYERED) {
+    if (ignore_unknown_cells_near_start) {
+      planning_octree_ = planning_octree;
+      octree_lookup_cache_.clear();
+      replaceUnknownByFreeCells(planning_octree->coordToKey(start_point), box_size_for_unknown_cells_replacement);
+    }
+    node_path = getLayeredNodePath(start_point, goal_point, planning_octree);
+  } else if (getSpeculativePlan(start_point, goal_point, node_path)) {
+    ROS_INFO_COND(verbose_, "[AstarPlanner]: Using plan found by speculative planning.");
+    start_.pose      = start_point;
+    start_.key       = planning_octree->coordToKey(start_point);
+    goal_            = node_path.back();  // cached plans always reach their goal
+    goal_.pose       = planning_octree->keyToCoord(goal_.key);
+    last_found_goal_ = goal_;
+  } else {
+    node_path =
+        getNodePath(start_point, goal_point, planning_octree, ignore_unknown_cells_near_start, box_size_for_unknown_cells_replacement, cost_upper_bound);
+  }
+  std::vector<octomap::point3d> waypoints = postprocessPath(node_path, planning_octree, make_path_straight, apply_postprocessing, postprocessing_safe_dist,
+                                                            postprocessing_max_iterations, postprocessing_horizontal_neighbors_only, postprocessing_z_tolerance,
+                                                            shortening_window_size, shortening_dist, apply_pruning, pruning_dist, planning_engine);
+
+  ROS_INFO("[%s]: ----------------- Init path -------------------", ros::this_node::getName().c_str());
+  for (size_t k = 0; k < node_path.size(); k++) {
+    octomap::point3d p = planning_octree->keyToCoord(node_path[k].key);
+    ROS_INFO("[%s]: Node %lu: [%.2f, %.2f, %.2f]", ros::this_node::getName().c_str(), k, p.x(), p.y(), p.z());
+  }
+
+  ROS_INFO("[%s]: ----------------- Final path -------------------", ros::this_node::getName().c_str());
+  for (size_t k = 0; k < waypoints.size(); k++) {
+    ROS_INFO("[%s]: Node %lu: [%.2f, %.2f, %.2f]", ros::this_node::getName().c_str(), k, waypoints[k].x(), waypoints[k].y(), waypoints[k].z());
+  }
+
+  session_recorder_.endRequest(waypoints, (ros::WallTime::now() - request_start).toSec());
+
+  bool direct_path_to_goal_found = false;  // TODO: return this bool from getNodePathFunction
+  return std::make_pair(waypoints, direct_path_to_goal_found);
+}
+
+//}
+
+/* postprocessPath() //{ */
+std::vector<octomap::point3d> AstarPlanner::postprocessPath(const std::vector<Node>& node_path, std::shared_ptr<octomap::OcTree> planning_octree,
+                                                            bool make_path_straight, bool apply_postprocessing, double postprocessing_safe_dist,
+                                                            int postprocessing_max_iterations, bool postprocessing_horizontal_neighbors_only,
+                                                            double postprocessing_z_tolerance, int shortening_window_size, double shortening_dist,
+                                                            bool apply_pruning, double pruning_dist, PlanningEngine planning_engine) {
+  initializeGridParams(planning_octree);
+  ros::WallTime stage_start = ros::WallTime::now();
+  perf_counters_.start();
+
   std::vector<octomap::point3d>   waypoints;
   std::vector<octomap::OcTreeKey> waypoints_keys;
-
-  start = ros::Time::now();
-  if (apply_postprocessing) {
-    waypoints_keys = getSafePath(getKeyPath(node_path), postprocessing_safe_dist, postprocessing_max_iterations, postprocessing_z_tolerance, true,
-                                 postprocessing_horizontal_neighbors_only);
+  std::vector<Node>               nodes = node_path;
+
+  ros::Time start = ros::Time::now();
+  if (planning_engine == PlanningEngine::INFORMED_RRT_STAR || planning_engine == PlanningEngine::STATE_LATTICE) {
+    ROS_WARN_COND(apply_postprocessing || make_path_straight, "[%s]: Path postprocessing is applied to grid A* paths only.", ros::this_node::getName().c_str());
+    waypoints = getWaypointPath(node_path);  // consecutive nodes are not neighbors in the grid, postprocessing requires connected key path
+  } else if (apply_postprocessing) {
+    // the penalty already trades zigzags of grid A* paths for length, paths of the other engines are filtered regardless of it
+    bool filter_zigzags = !(planning_engine == PlanningEngine::ASTAR && vertical_oscillation_penalty_ > 0.0);
+    waypoints_keys      = getSafePath(getKeyPath(node_path), postprocessing_safe_dist, postprocessing_max_iterations, postprocessing_z_tolerance, true,
+                                      postprocessing_horizontal_neighbors_only, filter_zigzags);
     std::vector<octomap::OcTreeKey> safe_filtered_key_plan =
         getFilteredPlan(waypoints_keys, shortening_window_size, shortening_dist);  // FIXME: check whether there was no reason to comment this out
     waypoints = getWaypointPath(safe_filtered_key_plan);
@@ -168,7 +365,7 @@ std::pair<std::vector<octomap::point3d>, bool> AstarPlanner::findPath(
     ROS_INFO("[%s]: Path postprocessing took %.2f s.", ros::this_node::getName().c_str(), (ros::Time::now() - start).toSec());
 
   } else if (make_path_straight) {
-    waypoints = getStraightenWaypointPath(node_path, 0.2);
+    waypoints = getStraightenWaypointPath(nodes, 0.2);
     ROS_INFO("[%s]: Path straightening took %.2f s.", ros::this_node::getName().c_str(), (ros::Time::now() - start).toSec());
   } else {
     waypoints = getWaypointPath(node_path);
@@ -180,29 +377,143 @@ std::pair<std::vector<octomap::point3d>, bool> AstarPlanner::findPath(
 
   waypoints = getWaypointPathWithoutObsoletePoints(waypoints, 0.05);
 
-  ROS_INFO("[%s]: ----------------- Init path -------------------", ros::this_node::getName().c_str());
-  for (size_t k = 0; k < node_path.size(); k++) {
-    octomap::point3d p = planning_octree->keyToCoord(node_path[k].key);
-    ROS_INFO("[%s]: Node %lu: [%.2f, %.2f, %.2f]", ros::this_node::getName().c_str(), k, p.x(), p.y(), p.z());
+  last_corridor_.clear();
+  if (corridor_generation_) {
+    start          = ros::Time::now();
+    last_corridor_ = generateCorridor(waypoints);
+    ROS_INFO_COND(verbose_, "[AstarPlanner]: Corridor of %lu boxes generated in %.3f ms.", last_corridor_.size(), (ros::Time::now() - start).toSec() * 1000.0);
   }
 
-  ROS_INFO("[%s]: ----------------- Final path -------------------", ros::this_node::getName().c_str());
-  for (size_t k = 0; k < waypoints.size(); k++) {
-    ROS_INFO("[%s]: Node %lu: [%.2f, %.2f, %.2f]", ros::this_node::getName().c_str(), k, waypoints[k].x(), waypoints[k].y(), waypoints[k].z());
+  last_planning_stats_.postprocessing_counters = perf_counters_.stop();
+  stage_latency_[int(PlanningStage::POSTPROCESSING)].record((ros::WallTime::now() - stage_start).toSec());
+  return waypoints;
+}
+//}
+
+/* generateCorridor() //{ */
+std::vector<CorridorBox> AstarPlanner::generateCorridor(const std::vector<octomap::point3d>& waypoints) {
+  std::vector<CorridorBox> corridor;
+  if (waypoints.size() < 2) {
+    return corridor;
   }
 
-  bool direct_path_to_goal_found = false;  // TODO: return this bool from getNodePathFunction
-  return std::make_pair(waypoints, direct_path_to_goal_found);
+  // own index of the region the boxes can grow into, pcl_map_ may be empty, filtered by the cost bound or built from another map at this point
+  octomap::point3d bbx_min = waypoints[0];
+  octomap::point3d bbx_max = waypoints[0];
+  for (auto& w : waypoints) {
+    for (int i = 0; i < 3; i++) {
+      bbx_min(i) = std::min(bbx_min(i), w(i));
+      bbx_max(i) = std::max(bbx_max(i), w(i));
+    }
+  }
+  float            reserve = corridor_max_box_size_ + corridor_obstacle_margin_ + resolution_;
+  octomap::point3d reserve_vec(reserve, reserve, reserve);
+  PCLMap           corridor_map;
+  corridor_map.setSensorOverlay(sensor_overlay_);
+  corridor_map.initKDTreeSearch(PCLMap::pclVectorToPointcloud(octomapToPointcloud(bbx_min - reserve_vec, bbx_max + reserve_vec)));
+
+  // segments whose bounding box is not free are split, consecutive boxes overlap in the shared segment end
+  std::vector<std::pair<octomap::point3d, octomap::point3d>> segments;
+  for (size_t k = 1; k < waypoints.size(); k++) {
+    segments.push_back(std::make_pair(waypoints[k - 1], waypoints[k]));
+  }
+  std::reverse(segments.begin(), segments.end());
+
+  while (!segments.empty()) {
+    std::pair<octomap::point3d, octomap::point3d> segment = segments.back();
+    segments.pop_back();
+
+    CorridorBox seed;
+    for (int i = 0; i < 3; i++) {
+      seed.min(i) = floor(std::min(segment.first(i), segment.second(i)) / resolution_) * resolution_;
+      seed.max(i) = (floor(std::max(segment.first(i), segment.second(i)) / resolution_) + 1) * resolution_;
+    }
+
+    if (isCorridorBoxFree(seed, corridor_map)) {
+      corridor.push_back(growCorridorBox(seed, corridor_map));
+    } else if (segment.first.distance(segment.second) > resolution_) {
+      octomap::point3d middle = (segment.first + segment.second) * 0.5;
+      segments.push_back(std::make_pair(middle, segment.second));
+      segments.push_back(std::make_pair(segment.first, middle));
+    } else {
+      ROS_WARN("[AstarPlanner]: Path segment at [%.2f, %.2f, %.2f] is too close to obstacles. Corridor not generated.", segment.first.x(), segment.first.y(),
+               segment.first.z());
+      return std::vector<CorridorBox>();
+    }
+  }
+
+  return corridor;
 }
+//}
+
+/* isCorridorBoxFree() //{ */
+bool AstarPlanner::isCorridorBoxFree(const CorridorBox& box, PCLMap& corridor_map) {
+  // obstacle points are cell centers, a cell is free if it is known (or traversable unknown) and the nearest obstacle point is not its own center
+  double min_dist = std::max(0.5 * resolution_, corridor_obstacle_margin_);
+  int    n_x      = round((box.max.x() - box.min.x()) / resolution_);
+  int    n_y      = round((box.max.y() - box.min.y()) / resolution_);
+  int    n_z      = round((box.max.z() - box.min.z()) / resolution_);
+  for (int x = 0; x < n_x; x++) {
+    for (int y = 0; y < n_y; y++) {
+      for (int z = 0; z < n_z; z++) {
+        pcl::PointXYZ        p(box.min.x() + (x + 0.5) * resolution_, box.min.y() + (y + 0.5) * resolution_, box.min.z() + (z + 0.5) * resolution_);
+        octomap::OcTreeKey   key  = planning_octree_->coordToKey(octomap::point3d(p.x, p.y, p.z));
+        octomap::OcTreeNode* node = octree_lookup_cache_.search(planning_octree_.get(), key);
+        if (node == NULL ? !isUnknownCellTraversable(key) : planning_octree_->isNodeOccupied(node)) {
+          return false;
+        }
+        if (corridor_map.getDistanceFromNearestPoint(p) < min_dist) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+//}
 
+/* growCorridorBox() //{ */
+CorridorBox AstarPlanner::growCorridorBox(const CorridorBox& seed, PCLMap& corridor_map) {
+  // faces are moved by one cell in turns until no face can be moved
+  CorridorBox box   = seed;
+  bool        grown = true;
+  while (grown) {
+    grown = false;
+    for (int face = 0; face < 6; face++) {
+      int axis = face / 2;
+      if (box.max(axis) - box.min(axis) + resolution_ > corridor_max_box_size_ + 1e-3) {
+        continue;
+      }
+      CorridorBox slab = box;
+      if (face % 2 == 0) {
+        slab.max(axis) = box.min(axis);
+        slab.min(axis) = box.min(axis) - resolution_;
+      } else {
+        slab.min(axis) = box.max(axis);
+        slab.max(axis) = box.max(axis) + resolution_;
+      }
+      if (axis == 2 && (slab.min.z() < min_altitude_ || slab.max.z() > max_altitude_)) {
+        continue;
+      }
+      if (isCorridorBoxFree(slab, corridor_map)) {
+        box.min(axis) = std::min(box.min(axis), slab.min(axis));
+        box.max(axis) = std::max(box.max(axis), slab.max(axis));
+        grown         = true;
+      }
+    }
+  }
+  return box;
+}
 //}
 
 /* getNodePath() //{ */
 std::vector<Node> AstarPlanner::getNodePath(const octomap::point3d& start_point, const octomap::point3d& goal_point,
                                             std::shared_ptr<octomap::OcTree> planning_octree, bool ignore_unknown_cells_near_start,
-                                            double box_size_for_unknown_cells_replacement) {
+                                            double box_size_for_unknown_cells_replacement, double cost_upper_bound) {
 
   std::vector<Node> waypoints;
+  ros::WallTime     query_start = ros::WallTime::now();
+  ros::Time         start_time  = ros::Time::now();
 
   if (!initialized_) {
     ROS_WARN("[AstarPlanner]: Cannot start planning, planner not initialized. Returning empty path.");
@@ -210,6 +521,7 @@ std::vector<Node> AstarPlanner::getNodePath(const octomap::point3d& start_point,
   }
 
   planning_octree_ = planning_octree;
+  octree_lookup_cache_.clear();
   planning_octree_->getMetricSize(grid_params_.width, grid_params_.height, grid_params_.depth);
   planning_octree_->getMetricMin(grid_params_.min_x, grid_params_.min_y, grid_params_.min_z);
   planning_octree_->getMetricMax(grid_params_.max_x, grid_params_.max_y, grid_params_.max_z);
@@ -228,12 +540,36 @@ std::vector<Node> AstarPlanner::getNodePath(const octomap::point3d& start_point,
     replaceUnknownByFreeCells(start_key, box_size_for_unknown_cells_replacement);
   }
 
+  cost_upper_bound_ = cost_upper_bound;
+  if (cost_upper_bound_ >= 0.0) {
+    ROS_INFO_COND(verbose_, "[AstarPlanner]: Informed pruning with cost upper bound %.2f m.", cost_upper_bound_);
+  }
+
   waypoints = getNodePath();
 
+  // replanning is needed only if the bound was too tight for the current map, not if the goal is unreachable at all
+  if (cost_upper_bound_ >= 0.0 && !last_planning_stats_.goal_reached && last_planning_stats_.informed_pruned > 0) {
+    double remaining_time = planning_timeout_ - (ros::Time::now() - start_time).toSec();
+    if (remaining_time > 0.0) {
+      ROS_WARN("[AstarPlanner]: Goal not reached within cost upper bound %.2f m. Replanning without informed pruning.", cost_upper_bound_);
+      double former_planning_timeout = planning_timeout_;  // the replanning gets only the rest of the time budget
+      planning_timeout_              = remaining_time;
+      cost_upper_bound_              = -1.0;
+      start_.pose                    = start_point;
+      goal_.pose                     = goal_point;
+      waypoints                      = getNodePath();
+      planning_timeout_              = former_planning_timeout;
+    } else {
+      ROS_WARN("[AstarPlanner]: Goal not reached within cost upper bound %.2f m, no time left for replanning.", cost_upper_bound_);
+    }
+  }
+  cost_upper_bound_ = -1.0;
+
   if (waypoints.size() > 5) {
     safe_dist_prev_ = safe_dist_;
   }
 
+  query_latency_[int(QueryType::SINGLE)].record((ros::WallTime::now() - query_start).toSec());
   return waypoints;
 }
 //}
@@ -243,6 +579,7 @@ std::vector<Node> AstarPlanner::getNodePath(const std::vector<octomap::point3d>&
                                             bool ignore_unknown_cells_near_start, double box_size_for_unknown_cells_replacement) {
 
   std::vector<Node> waypoints;
+  ros::WallTime     query_start = ros::WallTime::now();
 
   if (!initialized_) {
     ROS_WARN("[AstarPlanner]: Cannot start planning, planner not initialized. Returning empty path.");
@@ -255,6 +592,7 @@ std::vector<Node> AstarPlanner::getNodePath(const std::vector<octomap::point3d>&
   }
 
   planning_octree_ = planning_octree;
+  octree_lookup_cache_.clear();
   planning_octree_->getMetricSize(grid_params_.width, grid_params_.height, grid_params_.depth);
   planning_octree_->getMetricMin(grid_params_.min_x, grid_params_.min_y, grid_params_.min_z);
   planning_octree_->getMetricMax(grid_params_.max_x, grid_params_.max_y, grid_params_.max_z);
@@ -281,6 +619,7 @@ std::vector<Node> AstarPlanner::getNodePath(const std::vector<octomap::point3d>&
         continue;
       } else {
         ROS_WARN("[AstarPlanner]: Partial path not found, returning found path.");
+        query_latency_[int(QueryType::MULTI_WAYPOINT)].record((ros::WallTime::now() - query_start).toSec());
         return waypoints;
       }
     } else {
@@ -294,6 +633,7 @@ std::vector<Node> AstarPlanner::getNodePath(const std::vector<octomap::point3d>&
     safe_dist_prev_ = safe_dist_;
   }
 
+  query_latency_[int(QueryType::MULTI_WAYPOINT)].record((ros::WallTime::now() - query_start).toSec());
   return waypoints;
 }
 //}
@@ -317,6 +657,7 @@ void AstarPlanner::replaceUnknownByFreeCells(const octomap::OcTreeKey& start_key
   for (auto& n : unknown_cells_centers) {
     planning_octree_->updateNode(n, false);
   }
+  octree_lookup_cache_.clear();
 
   octomap::point3d_list unknown_cells_centers_after;
   planning_octree_->getUnknownLeafCenters(unknown_cells_centers_after, p_min, p_max);
@@ -342,17 +683,29 @@ std::vector<Node> AstarPlanner::getNodePath() {
   goal_.h_cost  = 0.0;
 
   ros::Time start_time = ros::Time::now();
+  last_planning_stats_ = PlanningStats();
+  sensor_overlay_->update(start_time);
   ROS_INFO_COND(debug_, "[AstarPlanner] Start octomap to pointcloud");
-  std::vector<pcl::PointXYZ> pcl_points =
-      octomapToPointcloud();  // TODO: replace by detection of maxmin x, maxmin y and maxmin z, for reasonable setting of are
+  std::vector<pcl::PointXYZ> pcl_points;
+  ros::WallTime              stage_start = ros::WallTime::now();
+  perf_counters_.start();
+  if (!map_prepared_) {  // otherwise pcl_map_ was built in advance by getPreparedMap()
+    pcl_points = octomapToPointcloud();  // TODO: replace by detection of maxmin x, maxmin y and maxmin z, for reasonable setting of are
+    stage_latency_[int(PlanningStage::EXTRACTION)].record((ros::WallTime::now() - stage_start).toSec());
+  }
+  last_planning_stats_.extraction_counters = perf_counters_.stop();
 
-  if (pcl_points.size() > 0) {
-    ROS_INFO_COND(verbose_, "[AstarPlanner]: Start conversion");
-    pcl::PointCloud<pcl::PointXYZ>::Ptr simulated_pointcloud = PCLMap::pclVectorToPointcloud(pcl_points);
-    ROS_INFO_COND(debug_, "[AstarPlanner]: init kd tree start");
-    pcl_map_.initKDTreeSearch(simulated_pointcloud);
-    ROS_INFO_COND(debug_, "[AstarPlanner]: init kd tree end");
+  stage_start = ros::WallTime::now();
+  perf_counters_.start();
+  if (!map_prepared_) {
+    initObstacleMap(pcl_points);
+  }
+  last_planning_stats_.index_build_counters = perf_counters_.stop();
+  if (!map_prepared_) {
+    stage_latency_[int(PlanningStage::INDEX_BUILD)].record((ros::WallTime::now() - stage_start).toSec());
   }
+  stage_start = ros::WallTime::now();
+  perf_counters_.start();
 
   if (!checkValidityWithNeighborhood(goal_)) {
     ROS_WARN_COND(debug_, "[AstarPlanner]: Goal destination unreachable.");
@@ -361,6 +714,7 @@ std::vector<Node> AstarPlanner::getNodePath() {
       ROS_WARN_COND(verbose_, "[AstarPlanner]: Secondary goal in the neighborhood not found. Destination unreachable.");
       if (!enable_planning_to_unreachable_goal_) {
         ROS_WARN_COND(verbose_, "[AstarPlanner]: Planning to unreachable goal not allowed. Returning empty path.");
+        last_planning_stats_.search_counters = perf_counters_.stop();
         return waypoints;
       } else {
         ROS_INFO_COND(debug_, "[AstarPlanner]: Goal unreachable, but planning to unreachable goal allowed.");
@@ -380,29 +734,63 @@ std::vector<Node> AstarPlanner::getNodePath() {
     safe_dist_ = safe_dist_prev_;
   }
 
-  if (isNodeGoal(start_)) {
-    ROS_WARN("[AstarPlanner]: Planner initialized at goal position. Returning empty plan.");
-    waypoints.push_back(start_);
-    return waypoints;
+  double admissibility = latency_target_ > 0.0 ? tuned_admissibility_ : astar_admissibility_;  // raised when the memory budget is hit
+
+  std::vector<Node> seeds;  // nodes the search starts from
+  for (auto& candidate : start_candidates_) {  // multi-source search, unfeasible candidates are not used
+    Node n;
+    n.key    = planning_octree_->coordToKey(candidate.pose);
+    n.f_cost = candidate.initial_cost / resolution_;  // search costs are in key units
+    // no clearing distance around the start, unfeasible candidates fall back to the escape from the first one
+    octomap::OcTreeNode* node = octree_lookup_cache_.search(planning_octree_.get(), n.key);
+    if ((node == NULL ? isUnknownCellTraversable(n.key) : !planning_octree_->isNodeOccupied(node)) && checkValidityWithKDTree(n)) {
+      seeds.push_back(n);
+    }
   }
+  ROS_WARN_COND(!start_candidates_.empty() && seeds.empty(), "[AstarPlanner]: No feasible start candidate, planning from the first one.");
+
+  std::vector<Node> waypoints_init;
+  if (seeds.empty()) {
+    if (isNodeGoal(start_)) {
+      ROS_WARN("[AstarPlanner]: Planner initialized at goal position. Returning empty plan.");
+      waypoints.push_back(start_);
+      last_planning_stats_.search_counters = perf_counters_.stop();
+      return waypoints;
+    }
 
-  std::vector<Node> waypoints_init = getPathToNearestFeasibleNode(start_);
+    waypoints_init = getPathToNearestFeasibleNode(start_);
 
-  if (waypoints_init.size() > 0) {
-    start_ = waypoints_init.back();
-    ROS_WARN("[AstarPlanner]: Start position unfeasible. Generating path to nearest feasible node.");
+    if (waypoints_init.size() > 0) {
+      start_ = waypoints_init.back();
+      ROS_WARN("[AstarPlanner]: Start position unfeasible. Generating path to nearest feasible node.");
+    }
+    start_.f_cost = 0.0;
+    seeds.push_back(start_);
   }
 
   ROS_INFO_COND(debug_, "[AstarPlanner]: Add start into open list.");
-  start_.f_cost = 0.0;
-  open_list.push(start_);
-  open_set.insert(start_);
-  closed_list.insert(start_);
+  std::sort(seeds.begin(), seeds.end(), [](const Node& a, const Node& b) { return a.f_cost < b.f_cost; });  // the cheapest of duplicate keys is kept
+  std::unordered_set<Node, NodeHasher> seed_set;
+  for (auto& seed : seeds) {
+    seed.vertical_dir = 0;
+    if (!seed_set.insert(seed).second) {
+      continue;
+    }
+    seed.h_cost = admissibility * euclideanCost(seed);
+    seed.g_cost = seed.f_cost + seed.h_cost;
+    open_list.push(seed);
+    open_set.insert(seed);
+  }
   Node current;
-  Node nearest     = start_;
-  nearest.h_cost   = DBL_MAX;
+  Node   nearest      = seeds.front();
+  double nearest_dist = DBL_MAX;  // distance of the nearest node to the goal, h_cost is not comparable after the heuristic weight is raised
   int loop_counter = 1;
   int node_removed = 0;  // 0 for not present in open list, 1 for present and removed, -1 for present and not removed
+  // estimated bytes per entry, hash containers store the node, the next pointer and the cached hash, plus one bucket pointer
+  const size_t set_entry_size    = sizeof(Node) + 3 * sizeof(void*);
+  const size_t parent_entry_size = 2 * sizeof(Node) + 3 * sizeof(void*);
+  // cost bound in key units, slack covers the start and goal shifts caused by discretization and secondary goal search
+  double cost_bound_keys = cost_upper_bound_ >= 0.0 ? cost_upper_bound_ / resolution_ + 2.0 * sqrt(3.0) : -1.0;
   ROS_INFO_COND(debug_, "[AstarPlanner]: Start key = [%d, %d, %d]", start_.key.k[0], start_.key.k[1], start_.key.k[2]);
   ROS_INFO_COND(debug_, "[AstarPlanner]: Goal key = [%d, %d, %d]", goal_.key.k[0], goal_.key.k[1], goal_.key.k[2]);
 
@@ -414,18 +802,53 @@ std::vector<Node> AstarPlanner::getNodePath() {
         ROS_WARN("[AstarPlanner]: Planning timeout reached.");
         break;
       }
+      if (abort_planning_ && *abort_planning_) {
+        ROS_INFO_COND(debug_, "[AstarPlanner]: Planning aborted.");
+        break;
+      }
+      size_t search_memory = open_list.size() * sizeof(Node) + (open_set.size() + closed_list.size()) * set_entry_size + parent_list.size() * parent_entry_size;
+      last_planning_stats_.peak_search_memory = std::max(last_planning_stats_.peak_search_memory, search_memory);
+      // closed nodes and their parent entries cannot be dropped, the search ends with the best partial path when they alone exceed the budget
+      if (search_memory_budget_ > 0 && closed_list.size() * (set_entry_size + parent_entry_size) > search_memory_budget_) {
+        ROS_WARN("[AstarPlanner]: Search memory budget %lu B exceeded by the closed list of %lu nodes, search stopped.", search_memory_budget_,
+                 closed_list.size());
+        break;
+      }
+      if (search_memory_budget_ > 0 && search_memory > search_memory_budget_) {  // degrade to a greedier search with a bounded open list
+        admissibility = std::max(std::min(2.0 * admissibility, search_memory_max_admissibility_), admissibility);
+        for (auto& n : open_list.truncate(std::max(open_list.size() / 2, size_t(1)))) {
+          open_set.erase(n);
+          if (n != nearest) {  // path to the nearest node is reconstructed if the goal is not reached
+            parent_list.erase(n);
+          }
+        }
+        last_planning_stats_.memory_budget_hits++;
+        ROS_WARN_COND(verbose_, "[AstarPlanner]: Search memory budget %lu B exceeded, open list pruned to %lu nodes, heuristic weight raised to %.2f",
+                      search_memory_budget_, open_list.size(), admissibility);
+      }
     }
     current = open_list.top();
     open_set.erase(current);
     open_list.pop();
     closed_list.insert(current);
 
+    if (lazy_collision_checking_ && loop_counter > 1) {  // lazy mode: successors are validated only when expanded
+      if (!checkValidityWithNeighborhood(current)) {
+        loop_counter++;
+        continue;  // node stays in closed list, so it is not pushed again
+      }
+      if (euclideanCost(current) < nearest_dist) {
+        nearest      = current;
+        nearest_dist = euclideanCost(current);
+      }
+    }
+
     if (isNodeGoal(current)) {
       ROS_INFO_COND(debug_, "[AstarPlanner]: Goal found");
       break;
     }
     std::vector<Node> neighbors;
-    if (loop_counter == 1) {
+    if (seed_set.find(current) != seed_set.end()) {  // no parent direction to prune by
       neighbors = getNeighborhood26(current);
     } else {
       neighbors = getPossibleSuccessors(current.parent_key, current.key);
@@ -433,99 +856,1401 @@ std::vector<Node> AstarPlanner::getNodePath() {
     }
     for (std::vector<Node>::iterator it = neighbors.begin(); it != neighbors.end(); ++it) {
 
-      if (!checkValidityWithNeighborhood(*it)) {
+      if (!lazy_collision_checking_ && !checkValidityWithNeighborhood(*it)) {
         continue;
       }
 
+      double new_cost = current.f_cost + nodeDistance(current, *it);  // nodeDistance can be replaced with 1.0 for 6 neighborhood
+
+      if (unknown_space_traversal_ && octree_lookup_cache_.search(planning_octree_.get(), it->key) == NULL &&
+          !isNodeInTheNeighborhood(it->key, start_.key, clearing_dist_)) {  // move into unknown cell costs unknown_cost_factor_ times its length
+        new_cost += (unknown_cost_factor_ - 1.0) * nodeDistance(current, *it);
+      }
+
+      if (vertical_oscillation_penalty_ > 0.0) {  // state is augmented by the direction of the last vertical move
+        int dz           = it->key.k[2] - current.key.k[2];
+        int dir          = (dz > 0) - (dz < 0);
+        it->vertical_dir = dir != 0 ? dir : current.vertical_dir;
+        if (dir != 0 && current.vertical_dir != 0 && dir != current.vertical_dir) {
+          new_cost += vertical_oscillation_penalty_ / resolution_;
+        }
+      }
+
+      // seed with a higher initial cost is replaced if it is reached more cheaply from another seed before its expansion
+      if (seed_set.find(*it) != seed_set.end() && open_set.find(*it) != open_set.end() && open_list.conditional_remove(*it, new_cost) == 1) {
+        open_set.erase(*it);
+        seed_set.erase(*it);
+      }
+
       if (closed_list.find(*it) != closed_list.end() || open_set.find(*it) != open_set.end()) {
         continue;
       }
 
-      double new_cost = current.f_cost + nodeDistance(current, *it);  // nodeDistance can be replaced with 1.0 for 6 neighborhood
+      if (cost_bound_keys > 0.0 && new_cost + euclideanCost(*it) > cost_bound_keys) {  // node outside the informed region
+        last_planning_stats_.informed_pruned++;
+        continue;
+      }
+
+      /* node_removed    = open_list.conditional_remove(*it, new_cost); */
+      /* if (node_removed) {          // node present in open list */
+      /*   if (node_removed == -1) {  // node present with better cost */
+      /*     continue; */
+      /*   } */
+      /* } else if (closed_list.find(*it) != closed_list.end()) { */
+      /*   if (cost_so_far[*it] <= new_cost) { */
+      /*     continue; */
+      /*   } */
+      /*   closed_list.erase(*it); */
+      /* } */
+
+
+      it->f_cost = new_cost;
+      it->h_cost = admissibility * euclideanCost(*it);
+      /* it->g_cost = it->f_cost + it->h_cost; */
+      it->g_cost     = it->f_cost + it->h_cost;
+      it->parent_key = current.key;
+      if (!lazy_collision_checking_ && euclideanCost(*it) < nearest_dist) {
+        nearest      = *it;
+        nearest_dist = euclideanCost(*it);
+      }
+      parent_list[*it] = current;
+      open_set.insert(*it);
+      open_list.push(*it);
+    }
+    /* closed_list.insert(current); */
+    /* cost_so_far[current] = current.f_cost; */
+
+    loop_counter++;
+  }
+  last_planning_stats_.search_counters = perf_counters_.stop();
+  stage_latency_[int(PlanningStage::SEARCH)].record((ros::WallTime::now() - stage_start).toSec());
+  ROS_INFO("[AstarPlanner debug]: Astar ended after %d iterations", loop_counter);
+  last_planning_stats_.iterations          = loop_counter;
+  last_planning_stats_.final_admissibility = admissibility;
+  last_planning_stats_.planning_time       = (ros::Time::now() - start_time).toSec();
+  last_planning_stats_.goal_reached        = isNodeGoal(current);
+  last_planning_stats_.expansion_rate      = last_planning_stats_.planning_time > 0.0 ? closed_list.size() / last_planning_stats_.planning_time : 0.0;
+  updateLatencyController(last_planning_stats_);
+
+  ROS_INFO("[AstarPlanner debug]: Open set size %lu.", open_set.size());
+  if (batch_visualizer_) {
+    batch_visualizer_->clearVisuals();
+    batch_visualizer_->clearBuffers();
+    visualizeOccupiedPoints(pcl_points);
+    visualizeGoal(planning_octree_->keyToCoord(goal_.key));
+    visualizeExpansions(open_set, closed_list, *planning_octree_);
+    batch_visualizer_->publish();
+  }
+
+  // path reconstruction
+  if (!isNodeGoal(current)) {
+
+    if (break_at_timeout_) {
+      return std::vector<Node>();
+    }
+
+    ROS_WARN("[AstarPlanner]: Path not found, goal unreachable.");
+    octomap::point3d nearest_coords = planning_octree_->keyToCoord(nearest.key);
+    octomap::point3d goal_coords    = planning_octree_->keyToCoord(goal_.key);
+    ROS_INFO_COND(verbose_,
+                  "[AstarPlanner]: Path to nearest node to goal [%.2f, %.2f, %.2f] found. Replacing original goal [%.2f, %.2f, %.2f] by nearest node.",
+                  nearest_coords.x(), nearest_coords.y(), nearest_coords.z(), goal_coords.x(), goal_coords.y(), goal_coords.z());
+    if (!areKeysEqual(current.key, nearest.key)) {
+      ROS_INFO_COND(debug_, "[AstarPlanner]: current and nearest are not equal");
+      current = nearest;
+    }
+  }
+  last_found_goal_ = current;
+  ROS_INFO_COND(debug_, "[AstarPlanner]: start path reconstruction");
+  current.pose = planning_octree_->keyToCoord(current.key);
+  waypoints.push_back(current);
+  int counter = 0;
+  ROS_INFO_COND(debug_, "[AstarPlanner]: path reconstruction %d, waypoint key = [%d, %d, %d]", counter, waypoints[counter].key.k[0],
+                waypoints[counter].key.k[1], waypoints[counter].key.k[2]);
+  while (seed_set.find(waypoints[counter]) == seed_set.end()) {
+    waypoints.push_back(parent_list[waypoints[counter]]);
+    counter++;
+    waypoints[counter].pose = planning_octree_->keyToCoord(waypoints[counter].key);
+    ROS_INFO_COND(debug_, "[AstarPlanner]: path reconstruction %d, waypoint key = [%d, %d, %d]", counter, waypoints[counter].key.k[0],
+                  waypoints[counter].key.k[1], waypoints[counter].key.k[2]);
+    /* sleep(0.1); */
+  }
+  // reverse the path from end to beginning
+  ROS_INFO_COND(debug_, "[AstarPlanner]: reversing waypoints");
+  std::reverse(waypoints.begin(), waypoints.end());
+  waypoints_init.insert(waypoints_init.end(), waypoints.begin(), waypoints.end());
+  for (size_t k = 0; k < start_candidates_.size(); k++) {
+    if (areKeysEqual(planning_octree_->coordToKey(start_candidates_[k].pose), waypoints.front().key)) {
+      last_planning_stats_.start_candidate = k;
+      break;
+    }
+  }
+  /* stop_index         = 15; */
+  /* start_node_next    = waypoints[0]; */
+  ros::Time end_time = ros::Time::now();
+  ROS_INFO_COND(debug_, "[AstarPlanner]: AstarPlanner: returning path of %lu waypoints", waypoints_init.size());
+  ROS_WARN_COND(verbose_, "[AstarPlanner]: Path planning took %.3f ms", (end_time - start_time).toSec() * 1000.0);
+  return waypoints_init;
+}
+//}
+
+/* getInformedRrtStarPath() //{ */
+std::vector<Node> AstarPlanner::getInformedRrtStarPath(const octomap::point3d& start_point, const octomap::point3d& goal_point,
+                                                       std::shared_ptr<octomap::OcTree> planning_octree, bool ignore_unknown_cells_near_start,
+                                                       double box_size_for_unknown_cells_replacement) {
+  std::vector<Node> waypoints;
+
+  if (!initialized_) {
+    ROS_WARN("[AstarPlanner]: Cannot start planning, planner not initialized. Returning empty path.");
+    return waypoints;
+  }
+
+  planning_octree_ = planning_octree;
+  octree_lookup_cache_.clear();
+  planning_octree_->getMetricSize(grid_params_.width, grid_params_.height, grid_params_.depth);
+  planning_octree_->getMetricMin(grid_params_.min_x, grid_params_.min_y, grid_params_.min_z);
+  planning_octree_->getMetricMax(grid_params_.max_x, grid_params_.max_y, grid_params_.max_z);
+  grid_params_.max_z = max_altitude_;
+  grid_params_.min_z = min_altitude_;
+  resolution_        = planning_octree_->getResolution();
+
+  if (ignore_unknown_cells_near_start) {
+    replaceUnknownByFreeCells(planning_octree_->coordToKey(start_point), box_size_for_unknown_cells_replacement);
+  }
+
+  start_.pose = start_point;
+  start_.key  = planning_octree_->coordToKey(start_point);
+  goal_.pose  = goal_point;
+  goal_.key   = planning_octree_->coordToKey(goal_point);
+
+  ROS_INFO("[AstarPlanner]: Informed RRT* start, step size = %.2f", rrt_step_size_);
+  ros::Time start_time = ros::Time::now();
+  sensor_overlay_->update(start_time);
+  std::vector<pcl::PointXYZ> pcl_points = octomapToPointcloud();
+  initObstacleMap(pcl_points);
+
+  if (!checkValidityWithNeighborhood(goal_)) {
+    Node secondary_goal = getValidNodeInNeighborhood(goal_);
+    if (secondary_goal.key.k[0] == 0) {
+      ROS_WARN_COND(verbose_, "[AstarPlanner]: Secondary goal in the neighborhood not found. Destination unreachable.");
+      if (!enable_planning_to_unreachable_goal_) {
+        ROS_WARN_COND(verbose_, "[AstarPlanner]: Planning to unreachable goal not allowed. Returning empty path.");
+        return waypoints;
+      }
+    } else {
+      goal_      = secondary_goal;
+      goal_.pose = planning_octree_->keyToCoord(goal_.key);
+    }
+  }
+
+  std::vector<Node> waypoints_init = getPathToNearestFeasibleNode(start_);
+  if (waypoints_init.size() > 0) {
+    start_ = waypoints_init.back();
+    ROS_WARN("[AstarPlanner]: Start position unfeasible. Generating path to nearest feasible node.");
+  }
+
+  // rotation of the informed ellipsoid and RRT* rewiring constant for the sampled volume
+  double          c_min    = start_.pose.distance(goal_.pose);
+  Eigen::Vector3d s(start_.pose.x(), start_.pose.y(), start_.pose.z());
+  Eigen::Vector3d g(goal_.pose.x(), goal_.pose.y(), goal_.pose.z());
+  Eigen::Vector3d center   = (s + g) / 2.0;
+  Eigen::Matrix3d rotation = Eigen::Matrix3d::Identity();
+  if (c_min > 1e-5) {
+    Eigen::Matrix3d                   m = ((g - s) / c_min) * Eigen::Vector3d::UnitX().transpose();
+    Eigen::JacobiSVD<Eigen::Matrix3d> svd(m, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    Eigen::Vector3d                   d(1.0, 1.0, svd.matrixU().determinant() * svd.matrixV().determinant());
+    rotation = svd.matrixU() * d.asDiagonal() * svd.matrixV().transpose();
+  }
+  double volume = (grid_params_.max_x - grid_params_.min_x) * (grid_params_.max_y - grid_params_.min_y) * (grid_params_.max_z - grid_params_.min_z);
+  double gamma  = 2.0 * pow(1.0 + 1.0 / 3.0, 1.0 / 3.0) * pow(fmax(volume, 1.0) / (4.0 / 3.0 * M_PI), 1.0 / 3.0);
+
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::vector<RrtNode>                   tree;
+  RrtNode                                root;
+  root.pose = start_.pose;
+  tree.push_back(root);
+  int    goal_idx             = -1;
+  int    nearest_to_goal_idx  = 0;
+  double nearest_to_goal_dist = c_min;
+  int    iteration            = 0;
+
+  for (iteration = 0; iteration < rrt_max_iterations_; iteration++) {
+    if (iteration % 100 == 0 && (ros::Time::now() - start_time).toSec() > planning_timeout_) {
+      ROS_WARN("[AstarPlanner]: Planning timeout reached.");
+      break;
+    }
+
+    octomap::point3d sample;
+    if (goal_idx >= 0) {
+      sample = sampleInformedRegion(rotation, center, c_min, tree[goal_idx].cost);
+    } else if (uniform(random_generator_) < rrt_goal_bias_) {
+      sample = goal_.pose;
+    } else {
+      sample = octomap::point3d(grid_params_.min_x + uniform(random_generator_) * (grid_params_.max_x - grid_params_.min_x),
+                                grid_params_.min_y + uniform(random_generator_) * (grid_params_.max_y - grid_params_.min_y),
+                                grid_params_.min_z + uniform(random_generator_) * (grid_params_.max_z - grid_params_.min_z));
+    }
+
+    int    nearest_idx  = 0;
+    double nearest_dist = DBL_MAX;
+    for (size_t k = 0; k < tree.size(); k++) {
+      double dist = tree[k].pose.distance(sample);
+      if (dist < nearest_dist) {
+        nearest_dist = dist;
+        nearest_idx  = k;
+      }
+    }
+
+    // steer
+    octomap::point3d new_pose = sample;
+    if (nearest_dist > rrt_step_size_) {
+      new_pose = tree[nearest_idx].pose + (sample - tree[nearest_idx].pose) * (rrt_step_size_ / nearest_dist);
+    }
+    if (new_pose.x() < grid_params_.min_x || new_pose.x() > grid_params_.max_x || new_pose.y() < grid_params_.min_y || new_pose.y() > grid_params_.max_y ||
+        new_pose.z() < grid_params_.min_z || new_pose.z() > grid_params_.max_z) {
+      continue;
+    }
+    if (!checkValidityWithNeighborhood(planning_octree_->coordToKey(new_pose))) {
+      continue;
+    }
+
+    // choose the cheapest collision-free parent among the near nodes
+    double                              n_nodes       = tree.size() + 1.0;
+    double                              rewire_radius = fmax(rrt_step_size_, fmin(2.0 * rrt_step_size_, gamma * pow(log(n_nodes) / n_nodes, 1.0 / 3.0)));
+    std::vector<int>                    near_idxs;
+    std::vector<std::pair<double, int>> parent_candidates;
+    for (size_t k = 0; k < tree.size(); k++) {
+      double dist = tree[k].pose.distance(new_pose);
+      if (dist < rewire_radius) {
+        near_idxs.push_back(k);
+        parent_candidates.push_back(std::make_pair(tree[k].cost + dist, k));
+      }
+    }
+    if (parent_candidates.empty()) {
+      parent_candidates.push_back(std::make_pair(tree[nearest_idx].cost + tree[nearest_idx].pose.distance(new_pose), nearest_idx));
+    }
+    std::sort(parent_candidates.begin(), parent_candidates.end());
+    int parent_idx = -1;
+    for (auto& candidate : parent_candidates) {
+      if (isSegmentCollisionFree(tree[candidate.second].pose, new_pose)) {
+        parent_idx = candidate.second;
+        break;
+      }
+    }
+    if (parent_idx < 0) {
+      continue;
+    }
+
+    RrtNode new_node;
+    new_node.pose   = new_pose;
+    new_node.parent = parent_idx;
+    new_node.cost   = tree[parent_idx].cost + tree[parent_idx].pose.distance(new_pose);
+    tree.push_back(new_node);
+    int new_idx = tree.size() - 1;
+    tree[parent_idx].children.push_back(new_idx);
+
+    // rewire
+    for (int idx : near_idxs) {
+      if (idx == parent_idx || idx == 0) {
+        continue;
+      }
+      double cost = tree[new_idx].cost + tree[new_idx].pose.distance(tree[idx].pose);
+      if (cost < tree[idx].cost - 1e-6 && isSegmentCollisionFree(tree[new_idx].pose, tree[idx].pose)) {
+        std::vector<int>& siblings = tree[tree[idx].parent].children;
+        siblings.erase(std::find(siblings.begin(), siblings.end(), idx));
+        tree[idx].parent = new_idx;
+        tree[new_idx].children.push_back(idx);
+        updateRrtSubtreeCost(tree, idx, cost - tree[idx].cost);
+      }
+    }
+
+    // goal connection
+    double dist_to_goal = new_pose.distance(goal_.pose);
+    if (dist_to_goal < nearest_to_goal_dist) {
+      nearest_to_goal_dist = dist_to_goal;
+      nearest_to_goal_idx  = new_idx;
+    }
+    if (dist_to_goal <= rrt_step_size_ && new_idx != goal_idx) {
+      double cost = tree[new_idx].cost + dist_to_goal;
+      if ((goal_idx < 0 || cost < tree[goal_idx].cost - 1e-6) && isSegmentCollisionFree(new_pose, goal_.pose)) {
+        if (goal_idx < 0) {
+          RrtNode goal_node;
+          goal_node.pose   = goal_.pose;
+          goal_node.parent = new_idx;
+          goal_node.cost   = cost;
+          tree.push_back(goal_node);
+          goal_idx = tree.size() - 1;
+          tree[new_idx].children.push_back(goal_idx);
+          ROS_INFO_COND(verbose_, "[AstarPlanner]: Informed RRT* found first solution of cost %.2f after %d iterations.", cost, iteration);
+        } else {
+          std::vector<int>& siblings = tree[tree[goal_idx].parent].children;
+          siblings.erase(std::find(siblings.begin(), siblings.end(), goal_idx));
+          tree[goal_idx].parent = new_idx;
+          tree[new_idx].children.push_back(goal_idx);
+          updateRrtSubtreeCost(tree, goal_idx, cost - tree[goal_idx].cost);
+        }
+      }
+    }
+  }
+  ROS_INFO("[AstarPlanner debug]: Informed RRT* ended after %d iterations, tree size %lu", iteration, tree.size());
+
+  int end_idx = goal_idx;
+  if (goal_idx < 0) {
+    if (break_at_timeout_) {
+      return std::vector<Node>();
+    }
+    ROS_WARN("[AstarPlanner]: Path not found, goal unreachable. Returning path to the nearest node to goal.");
+    end_idx = nearest_to_goal_idx;
+  }
+
+  // path reconstruction
+  for (int idx = end_idx; idx >= 0; idx = tree[idx].parent) {
+    Node n;
+    n.pose   = tree[idx].pose;
+    n.key    = planning_octree_->coordToKey(n.pose);
+    n.f_cost = tree[idx].cost / resolution_;
+    waypoints.push_back(n);
+  }
+  std::reverse(waypoints.begin(), waypoints.end());
+  last_found_goal_ = waypoints.back();
+  waypoints_init.insert(waypoints_init.end(), waypoints.begin(), waypoints.end());
+  ROS_WARN_COND(verbose_, "[AstarPlanner]: Informed RRT* planning took %.3f ms, path cost %.2f m", (ros::Time::now() - start_time).toSec() * 1000.0,
+                tree[end_idx].cost);
+  return waypoints_init;
+}
+//}
+
+/* isSegmentCollisionFree() //{ */
+bool AstarPlanner::isSegmentCollisionFree(const octomap::point3d& a, const octomap::point3d& b) {
+  octomap::point3d dir   = b - a;
+  int              steps = ceil(dir.norm() / resolution_);
+  for (int k = 1; k <= steps; k++) {
+    if (!checkValidityWithNeighborhood(planning_octree_->coordToKey(a + dir * (float(k) / steps)))) {
+      return false;
+    }
+  }
+  return true;
+}
+//}
+
+/* sampleInformedRegion() //{ */
+octomap::point3d AstarPlanner::sampleInformedRegion(const Eigen::Matrix3d& rotation, const Eigen::Vector3d& center, double c_min, double c_best) {
+  // uniform sample from the prolate spheroid of points with |x - start| + |x - goal| <= c_best
+  std::normal_distribution<double>       normal(0.0, 1.0);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  Eigen::Vector3d                        ball(normal(random_generator_), normal(random_generator_), normal(random_generator_));
+  ball = ball.normalized() * pow(uniform(random_generator_), 1.0 / 3.0);
+  double          r_transverse = sqrt(fmax(c_best * c_best - c_min * c_min, 0.0)) / 2.0;
+  Eigen::Vector3d radii(c_best / 2.0, r_transverse, r_transverse);
+  Eigen::Vector3d p = rotation * radii.asDiagonal() * ball + center;
+  return octomap::point3d(p.x(), p.y(), p.z());
+}
+//}
+
+/* updateRrtSubtreeCost() //{ */
+void AstarPlanner::updateRrtSubtreeCost(std::vector<RrtNode>& tree, int idx, double cost_diff) {
+  std::vector<int> stack = {idx};
+  while (!stack.empty()) {
+    int current = stack.back();
+    stack.pop_back();
+    tree[current].cost += cost_diff;
+    stack.insert(stack.end(), tree[current].children.begin(), tree[current].children.end());
+  }
+}
+//}
+
+/* getLayeredNodePath() //{ */
+std::vector<Node> AstarPlanner::getLayeredNodePath(const octomap::point3d& start_point, const octomap::point3d& goal_point,
+                                                   std::shared_ptr<octomap::OcTree> planning_octree) {
+  std::vector<Node> waypoints;
+
+  if (!initialized_) {
+    ROS_WARN("[AstarPlanner]: Cannot start planning, planner not initialized. Returning empty path.");
+    return waypoints;
+  }
+
+  initializeGridParams(planning_octree);
+  start_.pose       = start_point;
+  start_.key        = planning_octree_->coordToKey(start_point);
+  goal_.pose        = goal_point;
+  goal_.key         = planning_octree_->coordToKey(goal_point);
+  cost_upper_bound_ = -1.0;
+
+  ROS_INFO("[AstarPlanner]: Layered planning start, resolution = %.2f", resolution_);
+  ros::Time start_time = ros::Time::now();
+  sensor_overlay_->update(start_time);
+  std::vector<pcl::PointXYZ> pcl_points = octomapToPointcloud();
+  initObstacleMap(pcl_points);
+
+  std::vector<int> layer_cells;
+  for (auto& h : layer_heights_) {
+    layer_cells.push_back(std::max(1, int(round(h / resolution_))));
+  }
+  int max_ground_cells = ceil(layered_max_ground_dist_ / resolution_);
+  int start_ground     = getGroundLevel(start_.key, start_.key.k[2], 0, max_ground_cells);
+  int goal_ground      = getGroundLevel(goal_.key, goal_.key.k[2], 0, max_ground_cells);
+
+  int  goal_idx  = -1;
+  bool timed_out = false;
+  if (start_ground != INT_MIN && goal_ground != INT_MIN && !layer_cells.empty() && checkValidityWithNeighborhood(goal_)) {
+
+    auto state_id = [](const octomap::OcTreeKey& k) { return uint64_t(k.k[0]) | (uint64_t(k.k[1]) << 16) | (uint64_t(k.k[2]) << 32); };
+
+    std::vector<LayeredNode>                                                                                              nodes;
+    std::unordered_map<uint64_t, int>                                                                                     state_idxs;
+    std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> open_list;
+
+    auto add_successor = [&](int parent_idx, const octomap::OcTreeKey& key, int layer, int ground, double step_cost) {
+      double g_cost   = nodes[parent_idx].g_cost + step_cost;
+      auto   state_it = state_idxs.find(state_id(key));
+      if (state_it != state_idxs.end() && (nodes[state_it->second].closed || nodes[state_it->second].g_cost <= g_cost)) {
+        return;
+      }
+      int idx;
+      if (state_it == state_idxs.end()) {
+        LayeredNode n;
+        n.key = key;
+        nodes.push_back(n);
+        idx                       = nodes.size() - 1;
+        state_idxs[state_id(key)] = idx;
+      } else {
+        idx = state_it->second;
+      }
+      nodes[idx].layer  = layer;
+      nodes[idx].ground = ground;
+      nodes[idx].g_cost = g_cost;
+      nodes[idx].parent = parent_idx;
+      open_list.push(std::make_pair(g_cost + astar_admissibility_ * keyEuclideanDist(key, goal_.key), idx));
+    };
+
+    LayeredNode start_node;
+    start_node.key    = start_.key;
+    start_node.layer  = -1;
+    start_node.ground = start_ground;
+    nodes.push_back(start_node);
+    state_idxs[state_id(start_.key)] = 0;
+    open_list.push(std::make_pair(astar_admissibility_ * keyEuclideanDist(start_.key, goal_.key), 0));
+
+    int loop_counter = 0;
+    while (!open_list.empty()) {
+      if (++loop_counter % 100 == 0 && (ros::Time::now() - start_time).toSec() > planning_timeout_) {
+        ROS_WARN("[AstarPlanner]: Planning timeout reached.");
+        timed_out = true;
+        break;
+      }
+
+      int current_idx = open_list.top().second;
+      open_list.pop();
+      if (nodes[current_idx].closed) {
+        continue;
+      }
+      nodes[current_idx].closed = true;
+      LayeredNode current       = nodes[current_idx];
+
+      // goal column reached, the rest of the path is vertical
+      if (current.key.k[0] == goal_.key.k[0] && current.key.k[1] == goal_.key.k[1] && isVerticalSegmentValid(current.key, goal_.key.k[2])) {
+        goal_idx = current_idx;
+        break;
+      }
+
+      if (current.layer < 0) {  // from start to all layers above the start column
+        for (size_t l = 0; l < layer_cells.size(); l++) {
+          octomap::OcTreeKey key = current.key;
+          key.k[2]               = current.ground + layer_cells[l];
+          if (isVerticalSegmentValid(current.key, key.k[2])) {
+            add_successor(current_idx, key, l, current.ground, abs(key.k[2] - current.key.k[2]));
+          }
+        }
+        continue;
+      }
+
+      // transitions to the neighboring layers
+      for (int l : {current.layer - 1, current.layer + 1}) {
+        if (l < 0 || l >= int(layer_cells.size())) {
+          continue;
+        }
+        octomap::OcTreeKey key = current.key;
+        key.k[2]               = current.ground + layer_cells[l];
+        if (isVerticalSegmentValid(current.key, key.k[2])) {
+          add_successor(current_idx, key, l, current.ground, abs(key.k[2] - current.key.k[2]));
+        }
+      }
+
+      // 8-neighborhood in the current layer, the ground may change by one cell per step
+      for (int dx = -1; dx < 2; dx++) {
+        for (int dy = -1; dy < 2; dy++) {
+          if (dx == 0 && dy == 0) {
+            continue;
+          }
+          octomap::OcTreeKey key = current.key;
+          key.k[0] += dx;
+          key.k[1] += dy;
+          int ground = getGroundLevel(key, current.ground, 1, 1);
+          if (ground == INT_MIN) {
+            continue;
+          }
+          key.k[2] = ground + layer_cells[current.layer];
+          if (abs(key.k[2] - current.key.k[2]) > 1 || !checkValidityWithNeighborhood(key)) {
+            continue;
+          }
+          add_successor(current_idx, key, current.layer, ground, sqrt(dx * dx + dy * dy + pow(key.k[2] - current.key.k[2], 2)));
+        }
+      }
+    }
+
+    if (goal_idx >= 0) {
+      std::vector<int> sequence;
+      for (int idx = goal_idx; idx >= 0; idx = nodes[idx].parent) {
+        sequence.push_back(idx);
+      }
+      std::reverse(sequence.begin(), sequence.end());
+
+      // vertical transitions are filled by intermediate keys to keep the path connected for postprocessing
+      std::vector<octomap::OcTreeKey> keys;
+      for (size_t k = 0; k < sequence.size(); k++) {
+        const octomap::OcTreeKey& key = nodes[sequence[k]].key;
+        if (!keys.empty() && keys.back().k[0] == key.k[0] && keys.back().k[1] == key.k[1]) {
+          int step = key.k[2] > keys.back().k[2] ? 1 : -1;
+          for (int z = keys.back().k[2] + step; z != key.k[2]; z += step) {
+            octomap::OcTreeKey intermediate = key;
+            intermediate.k[2]               = z;
+            keys.push_back(intermediate);
+          }
+        }
+        keys.push_back(key);
+      }
+      int step = goal_.key.k[2] > keys.back().k[2] ? 1 : -1;
+      for (int z = keys.back().k[2]; z != goal_.key.k[2];) {
+        z += step;
+        octomap::OcTreeKey intermediate = keys.back();
+        intermediate.k[2]               = z;
+        keys.push_back(intermediate);
+      }
+
+      double cost = 0.0;
+      for (size_t k = 0; k < keys.size(); k++) {
+        if (k > 0) {
+          cost += keyEuclideanDist(keys[k - 1], keys[k]);
+        }
+        Node n;
+        n.key    = keys[k];
+        n.pose   = planning_octree_->keyToCoord(keys[k]);
+        n.f_cost = cost;
+        waypoints.push_back(n);
+      }
+      last_found_goal_ = waypoints.back();
+      ROS_INFO("[AstarPlanner]: Layered planning found path of %lu nodes in %d iterations, %lu states generated.", waypoints.size(), loop_counter,
+               nodes.size());
+      ROS_WARN_COND(verbose_, "[AstarPlanner]: Layered planning took %.3f ms", (ros::Time::now() - start_time).toSec() * 1000.0);
+      return waypoints;
+    }
+  }
+
+  double remaining_time = planning_timeout_ - (ros::Time::now() - start_time).toSec();
+  if (timed_out || remaining_time <= 0.0) {
+    ROS_WARN("[AstarPlanner]: Goal not reached in altitude layers, no time left for 3D planning. Returning empty path.");
+    return waypoints;
+  }
+
+  // vertical shafts, start or goal far above ground and other cases not representable in the layers
+  ROS_WARN("[AstarPlanner]: Goal not reachable in altitude layers. Falling back to 3D planning.");
+  double former_planning_timeout = planning_timeout_;  // the fallback gets only the rest of the time budget
+  planning_timeout_              = remaining_time;
+  map_prepared_                  = true;
+  waypoints                      = getNodePath(start_point, goal_point, planning_octree);
+  map_prepared_                  = false;
+  planning_timeout_              = former_planning_timeout;
+  return waypoints;
+}
+//}
+
+/* getGroundLevel() //{ */
+int AstarPlanner::getGroundLevel(const octomap::OcTreeKey& column, int ref_z, int max_up, int max_down) {
+  // highest non-free cell with free cell above it in the range [ref_z - max_down, ref_z + max_up], INT_MIN if not found
+  auto is_free = [this, &column](int z) {
+    octomap::OcTreeKey   key  = column;
+    key.k[2]                  = z;
+    octomap::OcTreeNode* node = octree_lookup_cache_.search(planning_octree_.get(), key);
+    return node != NULL && !planning_octree_->isNodeOccupied(node);
+  };
+  for (int z = std::min(ref_z + max_up, 65534); z >= std::max(ref_z - max_down, 0); z--) {
+    if (!is_free(z) && is_free(z + 1)) {
+      return z;
+    }
+  }
+  return INT_MIN;
+}
+//}
+
+/* isVerticalSegmentValid() //{ */
+bool AstarPlanner::isVerticalSegmentValid(const octomap::OcTreeKey& key, int z_to) {
+  octomap::OcTreeKey k    = key;
+  int                step = z_to > key.k[2] ? 1 : -1;
+  for (int z = key.k[2]; z != z_to;) {
+    z += step;
+    k.k[2] = z;
+    if (!checkValidityWithNeighborhood(k)) {
+      return false;
+    }
+  }
+  return true;
+}
+//}
+
+/* getLatticeNodePath() //{ */
+std::vector<Node> AstarPlanner::getLatticeNodePath(const octomap::point3d& start_point, const octomap::point3d& goal_point,
+                                                   std::shared_ptr<octomap::OcTree> planning_octree, double start_yaw) {
+  std::vector<Node> waypoints;
+
+  if (!initialized_) {
+    ROS_WARN("[AstarPlanner]: Cannot start planning, planner not initialized. Returning empty path.");
+    return waypoints;
+  }
+
+  planning_octree_ = planning_octree;
+  octree_lookup_cache_.clear();
+  planning_octree_->getMetricSize(grid_params_.width, grid_params_.height, grid_params_.depth);
+  planning_octree_->getMetricMin(grid_params_.min_x, grid_params_.min_y, grid_params_.min_z);
+  planning_octree_->getMetricMax(grid_params_.max_x, grid_params_.max_y, grid_params_.max_z);
+  grid_params_.max_z = max_altitude_;
+  grid_params_.min_z = min_altitude_;
+  resolution_        = planning_octree_->getResolution();
+
+  start_.pose = start_point;
+  start_.key  = planning_octree_->coordToKey(start_point);
+  goal_.pose  = goal_point;
+  goal_.key   = planning_octree_->coordToKey(goal_point);
+
+  ROS_INFO("[AstarPlanner]: State lattice planning start, resolution = %.2f", resolution_);
+  ros::Time start_time = ros::Time::now();
+  sensor_overlay_->update(start_time);
+  std::vector<pcl::PointXYZ> pcl_points = octomapToPointcloud();
+  initObstacleMap(pcl_points);
+
+  if (!checkValidityWithNeighborhood(goal_)) {
+    Node secondary_goal = getValidNodeInNeighborhood(goal_);
+    if (secondary_goal.key.k[0] == 0) {
+      ROS_WARN_COND(verbose_, "[AstarPlanner]: Secondary goal in the neighborhood not found. Destination unreachable.");
+      if (!enable_planning_to_unreachable_goal_) {
+        ROS_WARN_COND(verbose_, "[AstarPlanner]: Planning to unreachable goal not allowed. Returning empty path.");
+        return waypoints;
+      }
+    } else {
+      goal_      = secondary_goal;
+      goal_.pose = planning_octree_->keyToCoord(goal_.key);
+    }
+  }
+
+  std::vector<Node> waypoints_init = getPathToNearestFeasibleNode(start_);
+  if (waypoints_init.size() > 0) {
+    start_     = waypoints_init.back();
+    start_yaw  = std::numeric_limits<double>::quiet_NaN();  // heading at the end of the escape path is not known
+    ROS_WARN("[AstarPlanner]: Start position unfeasible. Generating path to nearest feasible node.");
+  }
+
+  // lattice state is identified by key and heading
+  auto state_id = [](const octomap::OcTreeKey& k, int heading) {
+    return uint64_t(k.k[0]) | (uint64_t(k.k[1]) << 16) | (uint64_t(k.k[2]) << 32) | (uint64_t(heading) << 48);
+  };
+
+  std::vector<LatticeNode>                                                                              nodes;
+  std::unordered_map<uint64_t, int>                                                                     state_idxs;
+  std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> open_list;
+
+  int start_heading = std::isnan(start_yaw) ? -1 : (int(round(start_yaw / (M_PI / 4.0))) % 8 + 8) % 8;
+  for (int h = 0; h < 8; h++) {
+    if (start_heading >= 0 && h != start_heading) {
+      continue;
+    }
+    LatticeNode n;
+    n.key     = start_.key;
+    n.heading = h;
+    nodes.push_back(n);
+    state_idxs[state_id(n.key, h)] = nodes.size() - 1;
+    open_list.push(std::make_pair(astar_admissibility_ * keyEuclideanDist(n.key, goal_.key), nodes.size() - 1));
+  }
+
+  int    goal_idx     = -1;
+  int    nearest_idx  = 0;
+  double nearest_dist = DBL_MAX;
+  int    loop_counter = 0;
+
+  while (!open_list.empty()) {
+    if (++loop_counter % 100 == 0 && (ros::Time::now() - start_time).toSec() > (planning_timeout_ - map_conversion_time_)) {
+      ROS_WARN("[AstarPlanner]: Planning timeout reached.");
+      break;
+    }
+
+    int current_idx = open_list.top().second;
+    open_list.pop();
+    if (nodes[current_idx].closed) {
+      continue;
+    }
+    nodes[current_idx].closed = true;
+
+    double dist_to_goal = keyEuclideanDist(nodes[current_idx].key, goal_.key);
+    if (dist_to_goal < nearest_dist) {
+      nearest_dist = dist_to_goal;
+      nearest_idx  = current_idx;
+    }
+    if (dist_to_goal <= lattice_goal_tolerance_) {
+      goal_idx = current_idx;
+      break;
+    }
+
+    const std::vector<MotionPrimitive>& primitives = motion_primitives_[nodes[current_idx].heading];
+    for (size_t p = 0; p < primitives.size(); p++) {
+      octomap::OcTreeKey end_key;
+      bool               key_in_range = true;
+      for (int i = 0; i < 3; i++) {
+        int k = nodes[current_idx].key.k[i] + primitives[p].end_offset[i];
+        if (k < 0 || k > std::numeric_limits<octomap::key_type>::max()) {
+          key_in_range = false;
+          break;
+        }
+        end_key.k[i] = k;
+      }
+      if (!key_in_range) {
+        continue;
+      }
+
+      double g_cost   = nodes[current_idx].g_cost + primitives[p].cost;
+      auto   state_it = state_idxs.find(state_id(end_key, primitives[p].end_heading));
+      if (state_it != state_idxs.end() && (nodes[state_it->second].closed || nodes[state_it->second].g_cost <= g_cost)) {
+        continue;
+      }
+
+      if (!isMotionPrimitiveFeasible(nodes[current_idx].key, primitives[p])) {
+        continue;
+      }
+
+      int next_idx;
+      if (state_it == state_idxs.end()) {
+        LatticeNode n;
+        n.key     = end_key;
+        n.heading = primitives[p].end_heading;
+        nodes.push_back(n);
+        next_idx = nodes.size() - 1;
+        state_idxs[state_id(end_key, n.heading)] = next_idx;
+      } else {
+        next_idx = state_it->second;
+      }
+      nodes[next_idx].g_cost    = g_cost;
+      nodes[next_idx].parent    = current_idx;
+      nodes[next_idx].primitive = p;
+      open_list.push(std::make_pair(g_cost + astar_admissibility_ * keyEuclideanDist(end_key, goal_.key), next_idx));
+    }
+  }
+  ROS_INFO("[AstarPlanner debug]: State lattice search ended after %d iterations, %lu states generated", loop_counter, nodes.size());
+
+  int end_idx = goal_idx;
+  if (goal_idx < 0) {
+    if (break_at_timeout_) {
+      return std::vector<Node>();
+    }
+    ROS_WARN("[AstarPlanner]: Path not found, goal unreachable. Returning path to the nearest state to goal.");
+    end_idx = nearest_idx;
+  }
+
+  // path reconstruction from the samples of the primitives
+  std::vector<int> state_sequence;
+  for (int idx = end_idx; idx >= 0; idx = nodes[idx].parent) {
+    state_sequence.push_back(idx);
+  }
+  std::reverse(state_sequence.begin(), state_sequence.end());
+
+  Node start_node = start_;
+  start_node.pose = planning_octree_->keyToCoord(start_.key);
+  waypoints.push_back(start_node);
+  for (size_t k = 1; k < state_sequence.size(); k++) {
+    const LatticeNode&     parent    = nodes[nodes[state_sequence[k]].parent];
+    const MotionPrimitive& primitive = motion_primitives_[parent.heading][nodes[state_sequence[k]].primitive];
+    octomap::point3d       origin    = planning_octree_->keyToCoord(parent.key);
+    for (auto& sample : primitive.samples) {
+      Node n;
+      n.pose   = origin + octomap::point3d(sample[0], sample[1], sample[2]) * resolution_;
+      n.key    = planning_octree_->coordToKey(n.pose);
+      n.f_cost = nodes[state_sequence[k]].g_cost;
+      waypoints.push_back(n);
+    }
+  }
+
+  if (goal_idx >= 0 && !isNodeGoal(waypoints.back()) && isSegmentCollisionFree(waypoints.back().pose, planning_octree_->keyToCoord(goal_.key))) {
+    Node goal_node = goal_;
+    goal_node.pose = planning_octree_->keyToCoord(goal_.key);
+    waypoints.push_back(goal_node);
+  }
+
+  last_found_goal_ = waypoints.back();
+  waypoints_init.insert(waypoints_init.end(), waypoints.begin(), waypoints.end());
+  ROS_WARN_COND(verbose_, "[AstarPlanner]: State lattice planning took %.3f ms", (ros::Time::now() - start_time).toSec() * 1000.0);
+  return waypoints_init;
+}
+//}
+
+/* isMotionPrimitiveFeasible() //{ */
+bool AstarPlanner::isMotionPrimitiveFeasible(const octomap::OcTreeKey& start, const MotionPrimitive& primitive) {
+  primitive_points_.clear();
+  octomap::OcTreeKey key;
+  for (auto& offset : primitive.swept_offsets) {
+    key.k[0] = start.k[0] + offset[0];
+    key.k[1] = start.k[1] + offset[1];
+    key.k[2] = start.k[2] + offset[2];
+    if (isNodeInTheNeighborhood(key, start_.key, clearing_dist_)) {  // unknown
+      continue;
+    }
+    if (octree_lookup_cache_.search(planning_octree_.get(), key) == NULL && !isUnknownCellTraversable(key)) {
+      return false;
+    }
+    pcl::PointXYZ p = octomapKeyToPclPoint(key);
+    if (p.z < grid_params_.min_z || p.z > grid_params_.max_z) {
+      return false;
+    }
+    primitive_points_.push_back(p);
+  }
+  return pcl_map_.arePointsInSafeDistance(primitive_points_, safe_dist_);
+}
+//}
+
+/* getSubmapPath() //{ */
+std::vector<octomap::point3d> AstarPlanner::getSubmapPath(const octomap::point3d& start_point, const octomap::point3d& goal_point,
+                                                          SubmapCollection& submaps) {
+  std::vector<octomap::point3d> waypoints;
+
+  if (!initialized_ || submaps.size() == 0) {
+    ROS_WARN("[AstarPlanner]: Cannot start planning, planner not initialized or no submaps given. Returning empty path.");
+    return waypoints;
+  }
+
+  // grid aligned with the world origin, cell coordinates are not limited by the 16-bit octree keys
+  double resolution = submaps.getResolution();
+  auto   to_cell    = [resolution](const octomap::point3d& p) {
+    return std::array<int, 3>{int(floor(p.x() / resolution)), int(floor(p.y() / resolution)), int(floor(p.z() / resolution))};
+  };
+  auto cell_center = [resolution](const std::array<int, 3>& c) {
+    return octomap::point3d((c[0] + 0.5) * resolution, (c[1] + 0.5) * resolution, (c[2] + 0.5) * resolution);
+  };
+  auto cell_id = [](const std::array<int, 3>& c) {
+    return (uint64_t(c[0] & 0x1FFFFF) << 42) | (uint64_t(c[1] & 0x1FFFFF) << 21) | uint64_t(c[2] & 0x1FFFFF);
+  };
+  auto cell_dist = [](const std::array<int, 3>& a, const std::array<int, 3>& b) {
+    return sqrt(pow(a[0] - b[0], 2) + pow(a[1] - b[1], 2) + pow(a[2] - b[2], 2));
+  };
+  auto is_valid = [&](const std::array<int, 3>& c) {
+    octomap::point3d p = cell_center(c);
+    if (p.z() < min_altitude_ || p.z() > max_altitude_) {
+      return false;
+    }
+    if (p.distance(start_point) < clearing_dist_) {  // unknown
+      return true;
+    }
+    if (submaps.getCellState(p) != CellState::FREE) {
+      return false;
+    }
+    return submaps.getDistanceFromNearestObstacle(p, safe_dist_) >= safe_dist_;
+  };
+
+  ros::Time          start_time = ros::Time::now();
+  std::array<int, 3> start_cell = to_cell(start_point);
+  std::array<int, 3> goal_cell  = to_cell(goal_point);
+
+  if (!is_valid(goal_cell)) {
+    bool secondary_goal_found = false;
+    for (int k = 0; k < 27 && !secondary_goal_found; k++) {
+      std::array<int, 3> neighbor = {goal_cell[0] + k % 3 - 1, goal_cell[1] + (k / 3) % 3 - 1, goal_cell[2] + k / 9 - 1};
+      if (is_valid(neighbor)) {
+        goal_cell            = neighbor;
+        secondary_goal_found = true;
+      }
+    }
+    if (!secondary_goal_found && !enable_planning_to_unreachable_goal_) {
+      ROS_WARN_COND(verbose_, "[AstarPlanner]: Secondary goal in the neighborhood not found. Planning to unreachable goal not allowed. Returning empty path.");
+      return waypoints;
+    }
+  }
+
+  std::unordered_map<uint64_t, int>                                                                                     idxs;
+  std::vector<std::array<int, 3>>                                                                                       nodes;
+  std::vector<double>                                                                                                   costs;
+  std::vector<int>                                                                                                      parents;
+  std::vector<bool>                                                                                                     closed;
+  std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> open_list;
+
+  nodes.push_back(start_cell);
+  costs.push_back(0.0);
+  parents.push_back(-1);
+  closed.push_back(false);
+  idxs[cell_id(start_cell)] = 0;
+  open_list.push(std::make_pair(astar_admissibility_ * cell_dist(start_cell, goal_cell), 0));
+
+  int    goal_idx     = -1;
+  int    nearest_idx  = 0;
+  double nearest_dist = DBL_MAX;
+  int    loop_counter = 0;
+  while (!open_list.empty()) {
+    if (++loop_counter % 100 == 0 && (ros::Time::now() - start_time).toSec() > planning_timeout_) {
+      ROS_WARN("[AstarPlanner]: Planning timeout reached.");
+      break;
+    }
+
+    int current_idx = open_list.top().second;
+    open_list.pop();
+    if (closed[current_idx]) {
+      continue;
+    }
+    closed[current_idx] = true;
+
+    double dist_to_goal = cell_dist(nodes[current_idx], goal_cell);
+    if (dist_to_goal < nearest_dist) {
+      nearest_dist = dist_to_goal;
+      nearest_idx  = current_idx;
+    }
+    if (nodes[current_idx] == goal_cell) {
+      goal_idx = current_idx;
+      break;
+    }
+
+    for (int k = 0; k < 27; k++) {
+      if (k == 13) {  // current cell
+        continue;
+      }
+      std::array<int, 3> neighbor = {nodes[current_idx][0] + k % 3 - 1, nodes[current_idx][1] + (k / 3) % 3 - 1, nodes[current_idx][2] + k / 9 - 1};
+      double             cost     = costs[current_idx] + cell_dist(nodes[current_idx], neighbor);
+
+      auto it = idxs.find(cell_id(neighbor));
+      if (it != idxs.end()) {
+        if (closed[it->second] || costs[it->second] <= cost) {
+          continue;
+        }
+        costs[it->second]   = cost;
+        parents[it->second] = current_idx;
+        open_list.push(std::make_pair(cost + astar_admissibility_ * cell_dist(neighbor, goal_cell), it->second));
+        continue;
+      }
+
+      nodes.push_back(neighbor);
+      costs.push_back(cost);
+      parents.push_back(current_idx);
+      idxs[cell_id(neighbor)] = nodes.size() - 1;
+      if (!is_valid(neighbor)) {
+        closed.push_back(true);  // invalid cells are stored as closed to be checked only once
+        continue;
+      }
+      closed.push_back(false);
+      open_list.push(std::make_pair(cost + astar_admissibility_ * cell_dist(neighbor, goal_cell), nodes.size() - 1));
+    }
+  }
+
+  int end_idx = goal_idx;
+  if (goal_idx < 0) {
+    if (break_at_timeout_) {
+      return waypoints;
+    }
+    ROS_WARN("[AstarPlanner]: Path not found, goal unreachable. Returning path to the nearest cell to goal.");
+    end_idx = nearest_idx;
+  }
+
+  for (int idx = end_idx; idx >= 0; idx = parents[idx]) {
+    waypoints.push_back(cell_center(nodes[idx]));
+  }
+  std::reverse(waypoints.begin(), waypoints.end());
+  waypoints = getWaypointPathWithoutObsoletePoints(waypoints, 0.05);
+
+  ROS_WARN_COND(verbose_, "[AstarPlanner]: Submap path planning took %.3f ms, %d of %lu submaps used for clearance.",
+                (ros::Time::now() - start_time).toSec() * 1000.0, submaps.getNumberOfClearanceMaps(), submaps.size());
+  return waypoints;
+}
+//}
+
+/* computeCostMatrix() //{ */
+std::pair<std::vector<std::vector<double>>, std::vector<std::vector<std::vector<octomap::point3d>>>> AstarPlanner::computeCostMatrix(
+    const std::vector<octomap::point3d>& points, std::shared_ptr<octomap::OcTree> planning_octree, bool return_paths) {
+
+  size_t                                                  n_points = points.size();
+  std::vector<std::vector<double>>                        costs(n_points, std::vector<double>(n_points, DBL_MAX));
+  std::vector<std::vector<std::vector<octomap::point3d>>> paths(return_paths ? n_points : 0, std::vector<std::vector<octomap::point3d>>(n_points));
+
+  if (!initialized_) {
+    ROS_WARN("[AstarPlanner]: Cannot compute cost matrix, planner not initialized. Returning infinite costs.");
+    return std::make_pair(costs, paths);
+  }
+
+  for (size_t k = 0; k < n_points; k++) {
+    costs[k][k] = 0.0;
+    if (return_paths) {
+      paths[k][k].push_back(points[k]);
+    }
+  }
+
+  if (n_points < 2) {
+    return std::make_pair(costs, paths);
+  }
+
+  // one map context shared by all searches, the searches only read from it
+  planning_octree_ = planning_octree;
+  octree_lookup_cache_.clear();
+  planning_octree_->getMetricSize(grid_params_.width, grid_params_.height, grid_params_.depth);
+  planning_octree_->getMetricMin(grid_params_.min_x, grid_params_.min_y, grid_params_.min_z);
+  planning_octree_->getMetricMax(grid_params_.max_x, grid_params_.max_y, grid_params_.max_z);
+  grid_params_.max_z = max_altitude_;
+  grid_params_.min_z = min_altitude_;
+  resolution_        = planning_octree_->getResolution();
+  cost_upper_bound_  = -1.0;
+
+  ros::Time start_time = ros::Time::now();
+  sensor_overlay_->update(start_time);
+  std::vector<pcl::PointXYZ> pcl_points = octomapToPointcloud();
+  // no decimation, the searches are not bound to a single start-goal segment, an empty map also drops the obstacles of the previous query
+  pcl_map_.initKDTreeSearch(PCLMap::pclVectorToPointcloud(pcl_points));
+
+  std::vector<octomap::OcTreeKey> keys;
+  for (auto& p : points) {
+    keys.push_back(planning_octree_->coordToKey(p));
+  }
+
+  // the graph is undirected, search from point i fills the costs to points j > i and the symmetric entries
+  std::atomic<int>         next_source(0);
+  int                      n_threads = std::max(1, std::min(int(std::thread::hardware_concurrency()), int(n_points) - 1));
+  std::vector<std::thread> workers;
+  for (int t = 0; t < n_threads; t++) {
+    workers.push_back(std::thread([&]() {
+      int source_idx;
+      while ((source_idx = next_source++) < int(n_points) - 1) {
+        computeCostMatrixRow(keys, source_idx, costs, paths, return_paths);
+      }
+    }));
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  ROS_INFO_COND(verbose_, "[AstarPlanner]: Cost matrix of %lu points computed in %.3f ms using %d threads.", n_points,
+                (ros::Time::now() - start_time).toSec() * 1000.0, n_threads);
+  return std::make_pair(costs, paths);
+}
+//}
+
+/* computeCostMatrixRow() //{ */
+void AstarPlanner::computeCostMatrixRow(const std::vector<octomap::OcTreeKey>& keys, int source_idx, std::vector<std::vector<double>>& costs,
+                                        std::vector<std::vector<std::vector<octomap::point3d>>>& paths, bool return_paths) {
+  // one-to-many Dijkstra search over the 26-neighborhood, terminates when all targets are reached
+  ros::Time start_time = ros::Time::now();
+
+  std::unordered_map<octomap::OcTreeKey, std::vector<int>, octomap::OcTreeKey::KeyHash> targets;
+  for (size_t j = source_idx + 1; j < keys.size(); j++) {
+    targets[keys[j]].push_back(j);
+  }
+  int n_remaining = keys.size() - source_idx - 1;
+
+  std::unordered_map<octomap::OcTreeKey, int, octomap::OcTreeKey::KeyHash>                                              idxs;
+  std::vector<octomap::OcTreeKey>                                                                                       nodes;
+  std::vector<double>                                                                                                   dists;
+  std::vector<int>                                                                                                      parents;
+  std::vector<bool>                                                                                                     closed;
+  std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> open_list;
+
+  nodes.push_back(keys[source_idx]);
+  dists.push_back(0.0);
+  parents.push_back(-1);
+  closed.push_back(false);
+  idxs[keys[source_idx]] = 0;
+  open_list.push(std::make_pair(0.0, 0));
+
+  int loop_counter = 0;
+  while (!open_list.empty() && n_remaining > 0) {
+    if (++loop_counter % 1000 == 0 && (ros::Time::now() - start_time).toSec() > planning_timeout_) {
+      ROS_WARN("[AstarPlanner]: Cost matrix search from point %d reached timeout, %d points unreachable.", source_idx, n_remaining);
+      break;
+    }
+
+    int current_idx = open_list.top().second;
+    open_list.pop();
+    if (closed[current_idx]) {
+      continue;
+    }
+    closed[current_idx] = true;
+
+    auto target_it = targets.find(nodes[current_idx]);
+    if (target_it != targets.end()) {
+      std::vector<octomap::point3d> path;
+      if (return_paths) {
+        for (int idx = current_idx; idx >= 0; idx = parents[idx]) {
+          path.push_back(planning_octree_->keyToCoord(nodes[idx]));
+        }
+      }
+      for (int j : target_it->second) {
+        costs[source_idx][j] = dists[current_idx] * resolution_;
+        costs[j][source_idx] = dists[current_idx] * resolution_;
+        if (return_paths) {
+          paths[j][source_idx] = path;
+          paths[source_idx][j] = std::vector<octomap::point3d>(path.rbegin(), path.rend());
+        }
+      }
+      n_remaining -= target_it->second.size();
+      targets.erase(target_it);
+    }
+
+    for (int a = -1; a < 2; a++) {
+      for (int b = -1; b < 2; b++) {
+        for (int c = -1; c < 2; c++) {
+          if (a == 0 && b == 0 && c == 0) {
+            continue;
+          }
+          octomap::OcTreeKey neighbor = nodes[current_idx];
+          neighbor.k[0] += a;
+          neighbor.k[1] += b;
+          neighbor.k[2] += c;
+          double dist = dists[current_idx] + sqrt(abs(a) + abs(b) + abs(c));
+
+          auto it = idxs.find(neighbor);
+          if (it != idxs.end()) {
+            if (closed[it->second] || dists[it->second] <= dist) {
+              continue;
+            }
+            dists[it->second]   = dist;
+            parents[it->second] = current_idx;
+            open_list.push(std::make_pair(dist, it->second));
+            continue;
+          }
+
+          nodes.push_back(neighbor);
+          dists.push_back(dist);
+          parents.push_back(current_idx);
+          idxs[neighbor] = nodes.size() - 1;
+          if (!checkValidityForCostMatrix(neighbor, keys)) {
+            closed.push_back(true);  // invalid nodes are stored as closed to be checked only once
+            continue;
+          }
+          closed.push_back(false);
+          open_list.push(std::make_pair(dist, nodes.size() - 1));
+        }
+      }
+    }
+  }
+}
+//}
+
+/* checkValidityForCostMatrix() //{ */
+bool AstarPlanner::checkValidityForCostMatrix(const octomap::OcTreeKey& k, const std::vector<octomap::OcTreeKey>& keys) {
+  // does not use start_, can be called from multiple threads
+  octomap::point3d p = planning_octree_->keyToCoord(k);
+  if (p.x() < grid_params_.min_x || p.x() > grid_params_.max_x || p.y() < grid_params_.min_y || p.y() > grid_params_.max_y || p.z() < grid_params_.min_z ||
+      p.z() > grid_params_.max_z) {
+    return false;
+  }
+  for (auto& key : keys) {
+    if (isNodeInTheNeighborhood(k, key, clearing_dist_)) {  // every point of interest has its clearing region, as the start in getNodePath()
+      return true;
+    }
+  }
+  if (planning_octree_->search(k) == NULL) {  // not cached, called from several threads
+    return false;
+  }
+  return pcl_map_.getDistanceFromNearestPoint(octomapKeyToPclPoint(k)) >= safe_dist_;
+}
+//}
+
+/* getPreparedMap() //{ */
+PCLMap AstarPlanner::getPreparedMap(std::shared_ptr<octomap::OcTree> planning_octree) {
+  PCLMap prepared_map;
+  initializeGridParams(planning_octree);
+  cost_upper_bound_ = -1.0;
+
+  std::vector<pcl::PointXYZ> pcl_points = octomapToPointcloud();
+  if (pcl_points.size() > 0) {
+    prepared_map.initKDTreeSearch(PCLMap::pclVectorToPointcloud(pcl_points));
+  }
+  return prepared_map;
+}
+//}
+
+/* getNodePath() //{ */
+std::vector<Node> AstarPlanner::getNodePath(const octomap::point3d& start_point, const octomap::point3d& goal_point,
+                                            std::shared_ptr<octomap::OcTree> planning_octree, const PCLMap& prepared_map) {
+  pcl_map_      = prepared_map;
+  map_prepared_ = true;
+  pcl_map_.setSensorOverlay(sensor_overlay_);
+  std::vector<Node> waypoints = getNodePath(start_point, goal_point, planning_octree);
+  map_prepared_ = false;
+  return waypoints;
+}
+//}
+
+/* getNodePath() //{ */
+std::vector<Node> AstarPlanner::getNodePath(const std::vector<StartCandidate>& start_candidates, const octomap::point3d& goal_point,
+                                            std::shared_ptr<octomap::OcTree> planning_octree) {
+  if (start_candidates.empty()) {
+    ROS_WARN("[AstarPlanner]: Cannot start planning, no start candidates given. Returning empty path.");
+    return std::vector<Node>();
+  }
+
+  // the first candidate is used as the start for the clearing distance and as a fallback if no candidate is feasible
+  start_candidates_           = start_candidates;
+  std::vector<Node> waypoints = getNodePath(start_candidates[0].pose, goal_point, planning_octree);
+  start_candidates_.clear();
+  ROS_INFO_COND(verbose_ && !waypoints.empty(), "[AstarPlanner]: Path starts from start candidate %d of %lu.", last_planning_stats_.start_candidate,
+                start_candidates.size());
+  return waypoints;
+}
+//}
+
+/* initializeGridParams() //{ */
+void AstarPlanner::initializeGridParams(std::shared_ptr<octomap::OcTree> planning_octree) {
+  planning_octree_ = planning_octree;
+  octree_lookup_cache_.clear();
+  planning_octree_->getMetricSize(grid_params_.width, grid_params_.height, grid_params_.depth);
+  planning_octree_->getMetricMin(grid_params_.min_x, grid_params_.min_y, grid_params_.min_z);
+  planning_octree_->getMetricMax(grid_params_.max_x, grid_params_.max_y, grid_params_.max_z);
+  grid_params_.max_z = max_altitude_;
+  grid_params_.min_z = min_altitude_;
+  resolution_        = planning_octree_->getResolution();
+}
+//}
+
+/* startSpeculativePlanning() //{ */
+void AstarPlanner::startSpeculativePlanning(const octomap::point3d& start_point, const std::vector<octomap::point3d>& goals,
+                                            std::shared_ptr<octomap::OcTree> planning_octree) {
+  stopSpeculativePlanning();
+
+  if (!initialized_ || goals.empty() || planning_octree == NULL) {
+    return;
+  }
 
-      /* node_removed    = open_list.conditional_remove(*it, new_cost); */
-      /* if (node_removed) {          // node present in open list */
-      /*   if (node_removed == -1) {  // node present with better cost */
-      /*     continue; */
-      /*   } */
-      /* } else if (closed_list.find(*it) != closed_list.end()) { */
-      /*   if (cost_so_far[*it] <= new_cost) { */
-      /*     continue; */
-      /*   } */
-      /*   closed_list.erase(*it); */
-      /* } */
+  // the caller keeps updating its map, the background planners work with a snapshot
+  std::shared_ptr<octomap::OcTree> octree_snapshot = std::make_shared<octomap::OcTree>(*planning_octree);
+  double                           tmp_x, tmp_y, tmp_z;  // metric bounds of a copied tree are computed lazily, shared by the workers they must be cached first
+  octree_snapshot->getMetricMin(tmp_x, tmp_y, tmp_z);
+  octree_snapshot->getMetricMax(tmp_x, tmp_y, tmp_z);
+
+  speculative_goals_          = goals;
+  speculative_goal_idx_       = 0;
+  abort_speculative_planning_ = false;
+  int n_threads               = std::min(int(goals.size()), speculative_max_threads_);
+  for (int k = 0; k < n_threads; k++) {
+    // configuration is copied here, the workers must not read members that this planner changes while they run
+    std::shared_ptr<AstarPlanner> planner = std::make_shared<AstarPlanner>();
+    copySearchSettings(*planner);
+    planner->abort_planning_ = &abort_speculative_planning_;
+    speculative_workers_.push_back(std::thread(&AstarPlanner::speculativePlanningLoop, this, planner, start_point, octree_snapshot, map_revision_.load(),
+                                               speculative_start_tolerance_, plan_cache_size_));
+  }
+  ROS_INFO_COND(verbose_, "[AstarPlanner]: Speculative planning toward %lu goals started in %d threads.", goals.size(), n_threads);
+}
+//}
 
+/* stopSpeculativePlanning() //{ */
+void AstarPlanner::stopSpeculativePlanning() {
+  abort_speculative_planning_ = true;
+  for (auto& worker : speculative_workers_) {
+    worker.join();
+  }
+  speculative_workers_.clear();
+}
+//}
 
-      it->f_cost = new_cost;
-      it->h_cost = astar_admissibility_ * euclideanCost(*it);
-      /* it->g_cost = it->f_cost + it->h_cost; */
-      it->g_cost     = it->f_cost + it->h_cost;
-      it->parent_key = current.key;
-      if (it->h_cost < nearest.h_cost) {
-        nearest = *it;
-      }
-      parent_list[*it] = current;
-      open_set.insert(*it);
-      open_list.push(*it);
-    }
-    /* closed_list.insert(current); */
-    /* cost_so_far[current] = current.f_cost; */
+/* updateLatencyController() //{ */
+void AstarPlanner::updateLatencyController(const PlanningStats& stats) {
+  if (latency_target_ <= 0.0) {
+    last_planning_stats_.tuned_admissibility = astar_admissibility_;
+    return;
+  }
 
-    loop_counter++;
+  latency_window_.push_back(stats.planning_time);
+  if (int(latency_window_.size()) > latency_window_size_) {
+    latency_window_.pop_front();
   }
-  ROS_INFO("[AstarPlanner debug]: Astar ended after %d iterations", loop_counter);
+  std::vector<double> latencies(latency_window_.begin(), latency_window_.end());
+  auto                p95_it = latencies.begin() + int(ceil(0.95 * latencies.size())) - 1;
+  std::nth_element(latencies.begin(), p95_it, latencies.end());
+  last_latency_p95_ = *p95_it;
+
+  // weight is changed only after a few searches with the current weight, the window is restarted after each change
+  const int    min_samples = 5;
+  const double step        = 1.25;
+  double       weight      = tuned_admissibility_;
+  if (int(latency_window_.size()) >= min_samples) {
+    if (last_latency_p95_ > latency_target_) {
+      weight = std::min(tuned_admissibility_ * step, latency_max_admissibility_);
+    } else if (last_latency_p95_ < 0.5 * latency_target_) {  // enough headroom to search for shorter paths
+      weight = std::max(tuned_admissibility_ / step, astar_admissibility_);
+    }
+  }
+  if (weight != tuned_admissibility_) {
+    ROS_INFO_COND(verbose_, "[AstarPlanner]: Latency p95 %.3f s for target %.3f s, heuristic weight changed from %.2f to %.2f", last_latency_p95_,
+                  latency_target_, tuned_admissibility_, weight);
+    tuned_admissibility_ = weight;
+    latency_window_.clear();
+  }
+  last_planning_stats_.latency_p95         = last_latency_p95_;
+  last_planning_stats_.tuned_admissibility = tuned_admissibility_;
+}
+//}
 
-  batch_visualizer_->clearVisuals();
-  batch_visualizer_->clearBuffers();
-  visualizeOccupiedPoints(pcl_points);
-  visualizeGoal(planning_octree_->keyToCoord(goal_.key));
-  ROS_INFO("[AstarPlanner debug]: Open set size %lu.", open_set.size());
-  visualizeExpansions(open_set, closed_list, *planning_octree_);
-  batch_visualizer_->publish();
+/* speculativePlanningLoop() //{ */
+void AstarPlanner::speculativePlanningLoop(std::shared_ptr<AstarPlanner> planner, octomap::point3d start_point,
+                                           std::shared_ptr<octomap::OcTree> planning_octree, uint64_t map_revision, double start_tolerance, int cache_size) {
+  setpriority(PRIO_PROCESS, syscall(SYS_gettid), 19);  // lowest priority, must not delay the planning for the current goal
 
-  // path reconstruction
-  if (!isNodeGoal(current)) {
+  int goal_idx;
+  while (!abort_speculative_planning_ && (goal_idx = speculative_goal_idx_++) < int(speculative_goals_.size())) {
+    std::vector<Node> node_path;
+    if (findCachedPlan(start_point, speculative_goals_[goal_idx], map_revision, start_tolerance, node_path)) {
+      continue;
+    }
 
-    if (break_at_timeout_) {
-      return std::vector<Node>();
+    node_path = planner->getNodePath(start_point, speculative_goals_[goal_idx], planning_octree);
+    if (abort_speculative_planning_) {  // path of aborted search is not complete
+      break;
+    }
+    if (!planner->getLastPlanningStats().goal_reached) {  // path to the nearest node would be returned as a plan to the goal
+      continue;
     }
 
-    ROS_WARN("[AstarPlanner]: Path not found, goal unreachable.");
-    octomap::point3d nearest_coords = planning_octree_->keyToCoord(nearest.key);
-    octomap::point3d goal_coords    = planning_octree_->keyToCoord(goal_.key);
-    ROS_INFO_COND(verbose_,
-                  "[AstarPlanner]: Path to nearest node to goal [%.2f, %.2f, %.2f] found. Replacing original goal [%.2f, %.2f, %.2f] by nearest node.",
-                  nearest_coords.x(), nearest_coords.y(), nearest_coords.z(), goal_coords.x(), goal_coords.y(), goal_coords.z());
-    if (!areKeysEqual(current.key, nearest.key)) {
-      ROS_INFO_COND(debug_, "[AstarPlanner]: current and nearest are not equal");
-      current = nearest;
+    std::scoped_lock lock(plan_cache_mutex_);
+    plan_cache_.push_back({start_point, speculative_goals_[goal_idx], map_revision, node_path});
+    if (int(plan_cache_.size()) > cache_size) {
+      plan_cache_.erase(plan_cache_.begin());
     }
   }
-  last_found_goal_ = current;
-  ROS_INFO_COND(debug_, "[AstarPlanner]: start path reconstruction");
-  current.pose = planning_octree_->keyToCoord(current.key);
-  waypoints.push_back(current);
-  int counter = 0;
-  ROS_INFO_COND(debug_, "[AstarPlanner]: path reconstruction %d, waypoint key = [%d, %d, %d]", counter, waypoints[counter].key.k[0],
-                waypoints[counter].key.k[1], waypoints[counter].key.k[2]);
-  while (abs(waypoints[counter].f_cost) > 1e-5) {
-    waypoints.push_back(parent_list[waypoints[counter]]);
-    counter++;
-    waypoints[counter].pose = planning_octree_->keyToCoord(waypoints[counter].key);
-    ROS_INFO_COND(debug_, "[AstarPlanner]: path reconstruction %d, waypoint key = [%d, %d, %d]", counter, waypoints[counter].key.k[0],
-                  waypoints[counter].key.k[1], waypoints[counter].key.k[2]);
-    /* sleep(0.1); */
+}
+//}
+
+/* copySearchSettings() //{ */
+void AstarPlanner::copySearchSettings(AstarPlanner& planner) {
+  planner.initialize(enable_planning_to_unreachable_goal_, planning_timeout_ + 0.2, safe_dist_, clearing_dist_, min_altitude_, max_altitude_, false, nullptr,
+                     break_at_timeout_);
+  planner.safe_dist_prev_                     = safe_dist_prev_;
+  planner.astar_admissibility_                = latency_target_ > 0.0 ? tuned_admissibility_ : astar_admissibility_;  // weight of the next search
+  planner.lazy_collision_checking_            = lazy_collision_checking_;
+  planner.vertical_oscillation_penalty_       = vertical_oscillation_penalty_;
+  planner.obstacle_decimation_voxel_size_     = obstacle_decimation_voxel_size_;
+  planner.obstacle_decimation_corridor_width_ = obstacle_decimation_corridor_width_;
+  planner.unknown_space_traversal_            = unknown_space_traversal_;
+  planner.unknown_cost_factor_                = unknown_cost_factor_;
+  planner.search_memory_budget_               = search_memory_budget_;
+  planner.search_memory_max_admissibility_    = search_memory_max_admissibility_;
+  planner.latency_max_admissibility_          = latency_max_admissibility_;
+}
+//}
+
+/* getSpeculativePlan() //{ */
+bool AstarPlanner::getSpeculativePlan(const octomap::point3d& start_point, const octomap::point3d& goal_point, std::vector<Node>& node_path) {
+  return findCachedPlan(start_point, goal_point, map_revision_.load(), speculative_start_tolerance_, node_path);
+}
+//}
+
+/* findCachedPlan() //{ */
+bool AstarPlanner::findCachedPlan(const octomap::point3d& start_point, const octomap::point3d& goal_point, uint64_t map_revision, double start_tolerance,
+                                  std::vector<Node>& node_path) {
+  std::scoped_lock lock(plan_cache_mutex_);
+  for (auto it = plan_cache_.rbegin(); it != plan_cache_.rend(); ++it) {
+    if (it->map_revision == map_revision && it->start.distance(start_point) <= start_tolerance && it->goal.distance(goal_point) <= start_tolerance &&
+        !it->node_path.empty()) {
+      node_path = it->node_path;
+      return true;
+    }
   }
-  // reverse the path from end to beginning
-  ROS_INFO_COND(debug_, "[AstarPlanner]: reversing waypoints");
-  std::reverse(waypoints.begin(), waypoints.end());
-  waypoints_init.insert(waypoints_init.end(), waypoints.begin(), waypoints.end());
-  /* stop_index         = 15; */
-  /* start_node_next    = waypoints[0]; */
-  ros::Time end_time = ros::Time::now();
-  ROS_INFO_COND(debug_, "[AstarPlanner]: AstarPlanner: returning path of %lu waypoints", waypoints_init.size());
-  ROS_WARN_COND(verbose_, "[AstarPlanner]: Path planning took %.3f ms", (end_time - start_time).toSec() * 1000.0);
-  return waypoints_init;
+  return false;
 }
 //}
 
@@ -572,7 +2297,8 @@ std::vector<Node> AstarPlanner::getPathToNearestFeasibleNode(const Node& start)
 
       for (std::vector<Node>::iterator it = neighbors.begin(); it != neighbors.end(); ++it) {
 
-        if (planning_octree_->search(it->key) == NULL || planning_octree_->isNodeOccupied(planning_octree_->search(it->key))) {
+        octomap::OcTreeNode* node = octree_lookup_cache_.search(planning_octree_.get(), it->key);
+        if (node == NULL || planning_octree_->isNodeOccupied(node)) {
           continue;
         }
 
@@ -643,11 +2369,115 @@ octomap::point3d AstarPlanner::getLastFoundGoal() {
 }
 //}
 
+/* getLastCorridor() //{ */
+std::vector<CorridorBox> AstarPlanner::getLastCorridor() {
+  return last_corridor_;
+}
+//}
+
+/* getLastPlanningStats() //{ */
+PlanningStats AstarPlanner::getLastPlanningStats() {
+  return last_planning_stats_;
+}
+//}
+
+/* startSessionRecording() //{ */
+bool AstarPlanner::startSessionRecording(const std::string& filename) {
+  return session_recorder_.open(filename);
+}
+//}
+
+/* stopSessionRecording() //{ */
+void AstarPlanner::stopSessionRecording() {
+  session_recorder_.close();
+}
+//}
+
+/* getStageLatencyHistogram() //{ */
+LatencyHistogram& AstarPlanner::getStageLatencyHistogram(const PlanningStage stage) {
+  return stage_latency_[int(stage)];
+}
+//}
+
+/* getQueryLatencyHistogram() //{ */
+LatencyHistogram& AstarPlanner::getQueryLatencyHistogram(const QueryType query_type) {
+  return query_latency_[int(query_type)];
+}
+//}
+
+/* resetLatencyHistograms() //{ */
+void AstarPlanner::resetLatencyHistograms() {
+  for (auto& h : stage_latency_) {
+    h.reset();
+  }
+  for (auto& h : query_latency_) {
+    h.reset();
+  }
+  ROS_INFO_COND(verbose_, "[AstarPlanner]: Latency histograms reset.");
+}
+//}
+
+/* getLatencyReport() //{ */
+std::string AstarPlanner::getLatencyReport(const bool json) {
+  static const char* stage_names[] = {"extraction", "index_build", "search", "postprocessing"};
+  static const char* query_names[] = {"single", "multi_waypoint", "repair", "validity_check"};
+
+  std::stringstream ss;
+  if (json) {
+    ss << "{\"stages\": {";
+    for (size_t k = 0; k < stage_latency_.size(); k++) {
+      ss << (k > 0 ? ", " : "") << "\"" << stage_names[k] << "\": " << stage_latency_[k].toJson();
+    }
+    ss << "}, \"queries\": {";
+    for (size_t k = 0; k < query_latency_.size(); k++) {
+      ss << (k > 0 ? ", " : "") << "\"" << query_names[k] << "\": " << query_latency_[k].toJson();
+    }
+    ss << "}}";
+  } else {
+    for (size_t k = 0; k < stage_latency_.size(); k++) {
+      ss << "stage " << stage_names[k] << ": " << stage_latency_[k].toString() << std::endl;
+    }
+    for (size_t k = 0; k < query_latency_.size(); k++) {
+      ss << "query " << query_names[k] << ": " << query_latency_[k].toString() << std::endl;
+    }
+  }
+  return ss.str();
+}
+//}
+
+/* getPathCostBound() //{ */
+double AstarPlanner::getPathCostBound(const std::vector<octomap::point3d>& previous_path, std::shared_ptr<octomap::OcTree> planning_octree) {
+  // returns length of the previous path if all its voxels are still known and free, negative value otherwise
+  if (previous_path.size() < 2 || !planning_octree) {
+    return -1.0;
+  }
+
+  double resolution = planning_octree->getResolution();
+  double path_cost  = 0.0;
+  for (size_t k = 1; k < previous_path.size(); k++) {
+    octomap::point3d dir   = previous_path[k] - previous_path[k - 1];
+    double           dl    = dir.norm();
+    int              steps = ceil(dl / resolution);
+    for (int s = 0; s <= steps; s++) {
+      octomap::point3d     p    = steps > 0 ? previous_path[k - 1] + dir * (float(s) / steps) : previous_path[k - 1];
+      octomap::OcTreeNode* node = planning_octree->search(p);
+      if (node == NULL || planning_octree->isNodeOccupied(node)) {
+        ROS_INFO_COND(verbose_, "[AstarPlanner]: Previous path blocked at [%.2f, %.2f, %.2f], cost bound not available.", p.x(), p.y(), p.z());
+        return -1.0;
+      }
+    }
+    path_cost += dl;
+  }
+  return path_cost;
+}
+//}
+
 /* getSafePath() //{ */
 std::vector<octomap::OcTreeKey> AstarPlanner::getSafePath(const std::vector<octomap::OcTreeKey>& key_path, double safe_dist, int max_iteration,
-                                                          double z_diff_tolerance, bool fix_goal_point, bool horizontal_neighbors_only) {
+                                                          double z_diff_tolerance, bool fix_goal_point, bool horizontal_neighbors_only, bool filter_zigzags) {
   /* bool visualization_pause_disabled = false; */
   ROS_INFO_COND(debug_, "[AstarPlanner]: GetSafePath start");
+  octree_lookup_cache_.clear();  // planning_octree_ may have been updated or pruned in place since the last query
   std::vector<octomap::OcTreeKey> local_path_keys;
   local_path_keys = key_path;
 
@@ -657,7 +2487,8 @@ std::vector<octomap::OcTreeKey> AstarPlanner::getSafePath(const std::vector<octo
     return local_path_keys;
   }
 
-  ros::Time start_time = ros::Time::now();
+  ros::Time     start_time  = ros::Time::now();
+  ros::WallTime query_start = ros::WallTime::now();
   // TODO: generate pointcloud for reasonable surrounding
   std::vector<int> map_limits = getMapLimits(key_path, 0, key_path.size(), ceil(4.0 / resolution_), ceil(4.0 / resolution_));
   ROS_INFO_COND(debug_, "[AstarPlanner]: octomap to pointcloud start");
@@ -741,20 +2572,14 @@ std::vector<octomap::OcTreeKey> AstarPlanner::getSafePath(const std::vector<octo
         ROS_INFO_COND(debug_, "[AstarPlanner]: Current node is in neighborhood of previous node. Adding the current node to local path.");
 
       } else {
-        std::vector<octomap::OcTreeKey> additional_waypoints = getAdditionalWaypoints3d(local_path_keys_next.back(), tmp_key);
+        std::array<octomap::OcTreeKey, 2> additional_waypoints = getAdditionalWaypoints3d(local_path_keys_next.back(), tmp_key);
         /* added_waypoints                                      = additional_waypoints; */
-        for (uint i = 0; i < additional_waypoints.size(); i++) {
-          local_path_keys_next.push_back(additional_waypoints[i]);
-        }
+        local_path_keys_next.insert(local_path_keys_next.end(), additional_waypoints.begin(), additional_waypoints.end());
         local_path_keys_next.push_back(tmp_key);
         has_changed = true;
-        ROS_INFO_COND(debug_ && (additional_waypoints.size() == 2),
-                      "[AstarPlanner]: Nodes are unconnected, adding nodes [%d, %d, %d], [%d, %d, %d] and [%d, %d, %d] to local path",
+        ROS_INFO_COND(debug_, "[AstarPlanner]: Nodes are unconnected, adding nodes [%d, %d, %d], [%d, %d, %d] and [%d, %d, %d] to local path",
                       additional_waypoints[0].k[0], additional_waypoints[0].k[1], additional_waypoints[0].k[2], additional_waypoints[1].k[0],
                       additional_waypoints[1].k[1], additional_waypoints[1].k[2], tmp_key.k[0], tmp_key.k[1], tmp_key.k[2]);
-        ROS_INFO_COND(debug_ && (additional_waypoints.size() == 1),
-                      "[AstarPlanner]: Nodes are unconnected, adding nodes [%d, %d, %d] and [%d, %d, %d] to local path", additional_waypoints[0].k[0],
-                      additional_waypoints[0].k[1], additional_waypoints[0].k[2], tmp_key.k[0], tmp_key.k[1], tmp_key.k[2]);
       }
     }
 
@@ -765,10 +2590,8 @@ std::vector<octomap::OcTreeKey> AstarPlanner::getSafePath(const std::vector<octo
           has_changed = true;
           ROS_INFO_COND(debug_, "[AstarPlanner]: Current node is in neighborhood of previous node. Adding the current node to local path.");
         } else {
-          std::vector<octomap::OcTreeKey> additional_waypoints = getAdditionalWaypoints3d(local_path_keys_next.back(), local_path_keys.back());
-          for (uint i = 0; i < additional_waypoints.size(); i++) {
-            local_path_keys_next.push_back(additional_waypoints[i]);
-          }
+          std::array<octomap::OcTreeKey, 2> additional_waypoints = getAdditionalWaypoints3d(local_path_keys_next.back(), local_path_keys.back());
+          local_path_keys_next.insert(local_path_keys_next.end(), additional_waypoints.begin(), additional_waypoints.end());
           local_path_keys_next.push_back(local_path_keys.back());
           has_changed = true;
         }
@@ -797,9 +2620,12 @@ std::vector<octomap::OcTreeKey> AstarPlanner::getSafePath(const std::vector<octo
   end_time        = ros::Time::now();
   local_path_keys = getFilteredNeighborhoodPlan(local_path_keys);
   local_path_keys = getStraightenKeyPath(local_path_keys);
-  local_path_keys = getZzFilteredPlan(local_path_keys, z_diff_tolerance);
+  if (filter_zigzags) {
+    local_path_keys = getZzFilteredPlan(local_path_keys, z_diff_tolerance);
+  }
   ROS_WARN_COND(debug_, "Get safe path took %.2f ms", (end_time - start_time).toSec() * 1000.0);
 
+  query_latency_[int(QueryType::REPAIR)].record((ros::WallTime::now() - query_start).toSec());
   return local_path_keys;
 }
 //}
@@ -1112,6 +2938,8 @@ std::pair<int, int> AstarPlanner::firstUnfeasibleNodeInPath(const std::vector<oc
                                                             const octomap::point3d& current_pose, double safe_dist_for_replanning,
                                                             double critical_dist_for_replanning) {
   ROS_INFO_COND(debug_, "[AstarPlanner]: First unfeasible node in path start.");
+  ros::WallTime       query_start = ros::WallTime::now();
+  octree_lookup_cache_.clear();  // planning_octree_ may have been updated or pruned in place since the last query
   std::pair<int, int> result;
   result.first         = -1;
   result.second        = -1;
@@ -1124,18 +2952,18 @@ std::pair<int, int> AstarPlanner::firstUnfeasibleNodeInPath(const std::vector<oc
     }
   }
   ROS_INFO_COND(debug_, "[AstarPlanner]: Current pose idx found.");
+  sensor_overlay_->update(ros::Time::now());
   uint                       end_index  = fmin(current_pose_idx + n_points_forward, key_waypoints.size());
   std::vector<int>           map_limits = getMapLimits(key_waypoints, current_pose_idx, end_index, ceil(2.0 / resolution_), ceil(2.0 / resolution_));
   std::vector<pcl::PointXYZ> pcl_points =
       octomapToPointcloud(map_limits);  // TODO: replace by detection of maxmin x, maxmin y and maxmin z, for reasonable setting of are
-  if (pcl_points.size() > 0) {
-    pcl::PointCloud<pcl::PointXYZ>::Ptr simulated_pointcloud = PCLMap::pclVectorToPointcloud(pcl_points);
-
-    ROS_INFO_COND(true, "[AstarPlanner]: Map limits: x = [%d, %d], y = [%d, %d], z = [%d, %d]", map_limits[0], map_limits[1], map_limits[2], map_limits[3],
-                  map_limits[4], map_limits[5]);
-    ROS_INFO_COND(debug_, "[AstarPlanner]: init kd tree start");
-    pcl_map_.initKDTreeSearch(simulated_pointcloud);
-    ROS_INFO_COND(debug_, "[AstarPlanner]: init kd tree end");
+  pcl::PointCloud<pcl::PointXYZ>::Ptr simulated_pointcloud = PCLMap::pclVectorToPointcloud(pcl_points);
+  ROS_INFO_COND(true, "[AstarPlanner]: Map limits: x = [%d, %d], y = [%d, %d], z = [%d, %d]", map_limits[0], map_limits[1], map_limits[2], map_limits[3],
+                map_limits[4], map_limits[5]);
+  ROS_INFO_COND(debug_, "[AstarPlanner]: init kd tree start");
+  pcl_map_.initKDTreeSearch(simulated_pointcloud);  // also for an empty window, obstacles of the previous map must not be queried
+  ROS_INFO_COND(debug_, "[AstarPlanner]: init kd tree end");
+  if (pcl_points.size() > 0 || sensor_overlay_->size() > 0) {
 
     /* for (uint k = current_pose_idx; k < end_index; k++) { */
     /*   Node n; */
@@ -1162,6 +2990,7 @@ std::pair<int, int> AstarPlanner::firstUnfeasibleNodeInPath(const std::vector<oc
     }
   }
 
+  query_latency_[int(QueryType::VALIDITY_CHECK)].record((ros::WallTime::now() - query_start).toSec());
   return result;
 }
 //}
@@ -1180,8 +3009,8 @@ std::vector<pcl::PointXYZ> AstarPlanner::octomapToPointcloud(const std::vector<i
         tmp_key.k[0] = x;
         tmp_key.k[1] = y;
         tmp_key.k[2] = z;
-        if (planning_octree_->search(tmp_key) == NULL ||
-            (planning_octree_->search(tmp_key) != NULL && planning_octree_->isNodeOccupied(planning_octree_->search(tmp_key)))) {
+        octomap::OcTreeNode* node = octree_lookup_cache_.search(planning_octree_.get(), tmp_key);
+        if ((node == NULL && !unknown_space_traversal_) || (node != NULL && planning_octree_->isNodeOccupied(node))) {
           octomap::point3d octomap_point = planning_octree_->keyToCoord(tmp_key);
           point.x                        = octomap_point.x();
           point.y                        = octomap_point.y();
@@ -1196,14 +3025,67 @@ std::vector<pcl::PointXYZ> AstarPlanner::octomapToPointcloud(const std::vector<i
 }
 //}
 
+/* initObstacleMap() //{ */
+void AstarPlanner::initObstacleMap(std::vector<pcl::PointXYZ>& pcl_points) {
+  if (pcl_points.empty()) {
+    pcl_map_.initKDTreeSearch(PCLMap::pclVectorToPointcloud(pcl_points));  // drops the fine and coarse trees of the previous map
+    return;
+  }
+  std::vector<pcl::PointXYZ> coarse_points;
+  if (obstacle_decimation_voxel_size_ > 0.0) {
+    coarse_points = decimateObstaclePoints(pcl_points);
+  }
+  ROS_INFO_COND(debug_, "[AstarPlanner]: init kd tree start");
+  pcl_map_.initKDTreeSearch(PCLMap::pclVectorToPointcloud(pcl_points));
+  if (!coarse_points.empty()) {
+    // every decimated point lies in the voxel of its representative, so it is at most half of the voxel diagonal far from it
+    pcl_map_.initCoarseKDTreeSearch(PCLMap::pclVectorToPointcloud(coarse_points), sqrt(3.0) * obstacle_decimation_voxel_size_ / 2.0);
+  }
+  ROS_INFO_COND(debug_, "[AstarPlanner]: init kd tree end");
+  ROS_INFO_COND(verbose_ && obstacle_decimation_voxel_size_ > 0.0, "[AstarPlanner]: Obstacle map built from %lu full resolution and %lu decimated points.",
+                pcl_points.size(), coarse_points.size());
+}
+//}
+
+/* decimateObstaclePoints() //{ */
+std::vector<pcl::PointXYZ> AstarPlanner::decimateObstaclePoints(std::vector<pcl::PointXYZ>& points) {
+  double             v = obstacle_decimation_voxel_size_;
+  std::vector<float> segment_distances(points.size());
+  getDistancesToSegment(points.data(), points.size(), pcl::PointXYZ(start_.pose.x(), start_.pose.y(), start_.pose.z()),
+                        pcl::PointXYZ(goal_.pose.x(), goal_.pose.y(), goal_.pose.z()), segment_distances.data());
+
+  std::unordered_set<uint64_t> coarse_cells;
+  std::vector<pcl::PointXYZ>   coarse_points;
+  size_t                       n_fine = 0;
+  for (size_t i = 0; i < points.size(); i++) {
+    const pcl::PointXYZ p = points[i];
+    if (segment_distances[i] <= obstacle_decimation_corridor_width_) {
+      points[n_fine++] = p;
+      continue;
+    }
+    int64_t  ix = int64_t(floor(p.x / v)), iy = int64_t(floor(p.y / v)), iz = int64_t(floor(p.z / v));
+    uint64_t id = (uint64_t(ix + (1 << 20)) << 42) | (uint64_t(iy + (1 << 20)) << 21) | uint64_t(iz + (1 << 20));
+    if (coarse_cells.insert(id).second) {
+      coarse_points.push_back(pcl::PointXYZ((ix + 0.5) * v, (iy + 0.5) * v, (iz + 0.5) * v));
+    }
+  }
+  points.resize(n_fine);
+  return coarse_points;
+}
+//}
+
 /* octomapToPointcloud() //{ */
 std::vector<pcl::PointXYZ> AstarPlanner::octomapToPointcloud() {
   std::vector<pcl::PointXYZ> output_pcl;
 
   for (octomap::OcTree::leaf_iterator it = planning_octree_->begin_leafs(), end = planning_octree_->end_leafs(); it != end; ++it) {
 
-    if (planning_octree_->search(it.getKey()) == NULL ||
-        (planning_octree_->search(it.getKey()) != NULL && planning_octree_->isNodeOccupied(planning_octree_->search(it.getKey())))) {
+    // obstacles farther than safe_dist_ from the informed region cannot affect any node that is pushed into the open list
+    if (cost_upper_bound_ >= 0.0 && !isInInformedRegion(planning_octree_->keyToCoord(it.getKey()), safe_dist_ + sqrt(3.0) * it.getSize() / 2.0)) {
+      continue;
+    }
+
+    if (planning_octree_->isNodeOccupied(*it)) {  // the iterator already points to the leaf, no search needed
 
       if (it.getDepth() == planning_octree_->getTreeDepth()) {
 
@@ -1240,6 +3122,31 @@ std::vector<pcl::PointXYZ> AstarPlanner::octomapToPointcloud() {
 }
 //}
 
+/* octomapToPointcloud() //{ */
+std::vector<pcl::PointXYZ> AstarPlanner::octomapToPointcloud(const octomap::point3d& bbx_min, const octomap::point3d& bbx_max) {
+  std::vector<pcl::PointXYZ> output_pcl;
+
+  for (octomap::OcTree::leaf_bbx_iterator it = planning_octree_->begin_leafs_bbx(bbx_min, bbx_max), end = planning_octree_->end_leafs_bbx(); it != end; ++it) {
+    if (!planning_octree_->isNodeOccupied(*it)) {
+      continue;
+    }
+    // leafs with non-maximum depth are represented by the centers of their cells
+    octomap::point3d center  = it.getCoordinate();
+    int              n_cells = std::max(int(round(it.getSize() / resolution_)), 1);
+    double           offset  = -0.5 * it.getSize() + 0.5 * resolution_;
+    for (int x = 0; x < n_cells; x++) {
+      for (int y = 0; y < n_cells; y++) {
+        for (int z = 0; z < n_cells; z++) {
+          output_pcl.push_back(pcl::PointXYZ(center.x() + offset + x * resolution_, center.y() + offset + y * resolution_, center.z() + offset + z * resolution_));
+        }
+      }
+    }
+  }
+
+  return output_pcl;
+}
+//}
+
 /* getKeyPath() //{ */
 std::vector<octomap::OcTreeKey> AstarPlanner::getKeyPath(const std::vector<Node>& plan) {
   std::vector<octomap::OcTreeKey> key_path;
@@ -1316,11 +3223,16 @@ std::vector<octomap::OcTreeKey> AstarPlanner::getAdditionalWaypoints(const octom
         additional_waypoints.push_back(res2);
       }
     } break;
-    case 2: {
-      additional_waypoints = getSafestWaypointsBetweenKeys(getPossibleWaypointsForTwoDiffCoord(k1, k2));
-    } break;
+    case 2:
     case 3: {
-      additional_waypoints = getSafestWaypointsBetweenKeys(getPossibleWaypointsForThreeDiffCoord(k1, k2));
+      ConnectionCandidates candidates;
+      if (nof_diff_coords == 2) {
+        getPossibleWaypointsForTwoDiffCoord(k1, k2, candidates);
+      } else {
+        getPossibleWaypointsForThreeDiffCoord(k1, k2, candidates);
+      }
+      int best_idx = getSafestConnectionCandidate(candidates);
+      additional_waypoints.assign(candidates.waypoints[best_idx].begin(), candidates.waypoints[best_idx].begin() + candidates.length);
     } break;
     default: {
       ROS_ERROR("[AstarPlanner]: Number of different coords = %d outside expected range. ", nof_diff_coords);
@@ -1331,176 +3243,148 @@ std::vector<octomap::OcTreeKey> AstarPlanner::getAdditionalWaypoints(const octom
 //}
 
 /* getAdditionalWaypoints3d() //{ */
-std::vector<octomap::OcTreeKey> AstarPlanner::getAdditionalWaypoints3d(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2) {
-  // k1 = from, k2 = to
-  octomap::OcTreeKey                           dir, diff, r1, r2;
-  std::vector<octomap::OcTreeKey>              partial_results;
-  std::vector<std::vector<octomap::OcTreeKey>> results;
-  diff.k[0] = abs(k2.k[0] - k1.k[0]);
-  diff.k[1] = abs(k2.k[1] - k1.k[1]);
-  diff.k[2] = abs(k2.k[2] - k1.k[2]);
-  /* if (diff.k[0] < 2 && diff.k[1] < 2 && diff.k[2] < 2) { */
-  /*   return getConnectionNode3d(k1, k2); */
-  /* } */
-  int                           dir_0 = k2.k[0] - k1.k[0] == 0 ? 0 : k2.k[0] - k1.k[0] > 0 ? 1 : -1;
-  int                           dir_1 = k2.k[1] - k1.k[1] == 0 ? 0 : k2.k[1] - k1.k[1] > 0 ? 1 : -1;
-  int                           dir_2 = k2.k[2] - k1.k[2] == 0 ? 0 : k2.k[2] - k1.k[2] > 0 ? 1 : -1;
-  std::vector<std::vector<int>> i0    = diff.k[0] == 0 ? idxs4 : diff.k[0] == 1 ? idxs3 : diff.k[0] == 2 ? idxs2 : idxs1;
-  std::vector<std::vector<int>> i1    = diff.k[1] == 0 ? idxs4 : diff.k[1] == 1 ? idxs3 : diff.k[1] == 2 ? idxs2 : idxs1;
-  std::vector<std::vector<int>> i2    = diff.k[2] == 0 ? idxs4 : diff.k[2] == 1 ? idxs3 : diff.k[2] == 2 ? idxs2 : idxs1;
-  for (size_t j = 0; j < i0.size(); j++) {
-    r1.k[0] = k2.k[0] + dir_0 * i0[j][0];
-    r2.k[0] = r1.k[0] + dir_0 * i0[j][1];
-    for (size_t k = 0; k < i1.size(); k++) {
-      r1.k[1] = k2.k[1] + dir_1 * i1[k][0];
-      r2.k[1] = r1.k[1] + dir_1 * i1[k][1];
-      for (size_t l = 0; l < i2.size(); l++) {
-        r1.k[2] = k2.k[2] + dir_2 * i2[l][0];
-        r2.k[2] = r1.k[2] + dir_2 * i2[l][1];
-        partial_results.clear();
-        partial_results.push_back(r2);
-        partial_results.push_back(r1);
-        results.push_back(partial_results);
-      }
-    }
-  }
-  /* partial_results = getSafestWaypointsBetweenKeys(results); */
-  return getSafestWaypointsBetweenKeys(results);
-}
-//}
-
-/* getSafestWaypointsBetweenKeys() //{ */
-std::vector<octomap::OcTreeKey> AstarPlanner::getSafestWaypointsBetweenKeys(const std::vector<std::vector<octomap::OcTreeKey>>& possible_waypoints) {
-  int    best_idx = 0;
-  double max_dist = -1.0;
-  double dist;
-  for (uint i = 0; i < possible_waypoints.size(); i++) {
-    dist = DBL_MAX;
-    for (uint j = 0; j < possible_waypoints[i].size(); j++) {
-      dist = fmin(pcl_map_.getDistanceFromNearestPoint(octomapKeyToPclPoint(possible_waypoints[i][j])), dist);
-    }
-    if (dist > max_dist) {
-      max_dist = dist;
-      best_idx = i;
+std::array<octomap::OcTreeKey, 2> AstarPlanner::getAdditionalWaypoints3d(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2) {
+  // k1 = from, k2 = to, returns the two cells leading from k1 to k2
+  std::array<int, 3>                   dir;
+  std::array<const TwoStepOffsets*, 3> offsets;
+  for (int m = 0; m < 3; m++) {
+    dir[m]     = (k2.k[m] > k1.k[m]) - (k2.k[m] < k1.k[m]);
+    offsets[m] = &two_step_offsets[std::min(abs(k2.k[m] - k1.k[m]), 3)];
+  }
+  ConnectionCandidates candidates;
+  candidates.length = 2;
+  octomap::OcTreeKey r1, r2;
+  for (int j = 0; j < offsets[0]->size; j++) {
+    r1.k[0] = k2.k[0] + dir[0] * offsets[0]->offsets[j][0];
+    r2.k[0] = r1.k[0] + dir[0] * offsets[0]->offsets[j][1];
+    for (int k = 0; k < offsets[1]->size; k++) {
+      r1.k[1] = k2.k[1] + dir[1] * offsets[1]->offsets[k][0];
+      r2.k[1] = r1.k[1] + dir[1] * offsets[1]->offsets[k][1];
+      for (int l = 0; l < offsets[2]->size; l++) {
+        r1.k[2]                                  = k2.k[2] + dir[2] * offsets[2]->offsets[l][0];
+        r2.k[2]                                  = r1.k[2] + dir[2] * offsets[2]->offsets[l][1];
+        candidates.waypoints[candidates.size][0] = r2;
+        candidates.waypoints[candidates.size][1] = r1;
+        candidates.size++;
+      }
     }
   }
-  return possible_waypoints[best_idx];
+  return candidates.waypoints[getSafestConnectionCandidate(candidates)];
 }
 //}
 
-/* getSafestWaypointsBetweenKeys() //{ */
-octomap::OcTreeKey AstarPlanner::getSafestWaypointsBetweenKeys(const std::vector<octomap::OcTreeKey>& possible_waypoints) {
+/* getSafestConnectionCandidate() //{ */
+int AstarPlanner::getSafestConnectionCandidate(const ConnectionCandidates& candidates) {
+  // all cells of all candidates are scored by one batched clearance query
+  std::array<pcl::PointXYZ, 2 * std::tuple_size<decltype(candidates.waypoints)>::value> points;
+  std::array<double, 2 * std::tuple_size<decltype(candidates.waypoints)>::value>        dists;
+  int                                                                                   n_points = 0;
+  for (int i = 0; i < candidates.size; i++) {
+    for (int j = 0; j < candidates.length; j++) {
+      points[n_points++] = octomapKeyToPclPoint(candidates.waypoints[i][j]);
+    }
+  }
+  pcl_map_.getDistancesFromNearestPoints(points.data(), n_points, dists.data());
+
   int    best_idx = 0;
   double max_dist = -1.0;
-  double dist     = DBL_MAX;
-  for (uint i = 0; i < possible_waypoints.size(); i++) {
-    dist = fmin(pcl_map_.getDistanceFromNearestPoint(octomapKeyToPclPoint(possible_waypoints[i])), dist);
+  for (int i = 0; i < candidates.size; i++) {
+    double dist = DBL_MAX;
+    for (int j = 0; j < candidates.length; j++) {
+      dist = fmin(dists[i * candidates.length + j], dist);
+    }
     if (dist > max_dist) {
       max_dist = dist;
       best_idx = i;
     }
   }
-  return possible_waypoints[best_idx];
+  return best_idx;
 }
 //}
 
 /* getPossibleWaypointsForTwoDiffCoord() //{ */
-std::vector<std::vector<octomap::OcTreeKey>> AstarPlanner::getPossibleWaypointsForTwoDiffCoord(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2) {
-  std::vector<std::vector<octomap::OcTreeKey>> result;
-  std::vector<int>                             diff_in_coords = getDifferenceInCoordinates(k1, k2);
+void AstarPlanner::getPossibleWaypointsForTwoDiffCoord(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2, ConnectionCandidates& result) {
+  std::vector<int> diff_in_coords = getDifferenceInCoordinates(k1, k2);
   // add solution for diagonaly connected nodes with manhattan distance equal to two
   if ((abs(k1.k[0] - k2.k[0]) + abs(k1.k[1] - k2.k[1]) + abs(k1.k[2] - k2.k[2])) == 2) {
-    result.resize(2);
-    for (uint i = 0; i < result.size(); i++) {
-      result[i].resize(1);
-    }
+    result.size      = 2;
+    result.length    = 1;
     bool switch_keys = false;
     for (int m = 0; m < 3; m++) {
       if (diff_in_coords[m] == 0) {
-        for (uint i = 0; i < result.size(); i++) {
-          for (uint j = 0; j < result[i].size(); j++) {
-            result[i][j].k[m] = k1.k[m];
+        for (int i = 0; i < result.size; i++) {
+          for (int j = 0; j < result.length; j++) {
+            result.waypoints[i][j].k[m] = k1.k[m];
           }
         }
       } else if (diff_in_coords[m] == 1) {
         if (switch_keys) {
-          result[0][0].k[m] = k1.k[m];
-          result[1][0].k[m] = k2.k[m];
-          switch_keys       = false;
+          result.waypoints[0][0].k[m] = k1.k[m];
+          result.waypoints[1][0].k[m] = k2.k[m];
+          switch_keys                 = false;
         } else {
-          result[0][0].k[m] = k2.k[m];
-          result[1][0].k[m] = k1.k[m];
-          switch_keys       = true;
+          result.waypoints[0][0].k[m] = k2.k[m];
+          result.waypoints[1][0].k[m] = k1.k[m];
+          switch_keys                 = true;
         }
       } else {
         ROS_WARN("[AstarPlanner]: Something is crazy: diff in coords %d = %d", m, diff_in_coords[m]);
       }
     }
   } else {
-    result.resize(3);
-    for (uint i = 0; i < result.size(); i++) {
-      result[i].resize(2);
-    }
+    result.size   = 3;
+    result.length = 2;
     for (int m = 0; m < 3; m++) {
+      int step = (k2.k[m] > k1.k[m]) - (k2.k[m] < k1.k[m]);
       if (diff_in_coords[m] == 0) {
-        for (uint i = 0; i < result.size(); i++) {
-          for (uint j = 0; j < 2; j++) {
-            result[i][j].k[m] = k1.k[m];
+        for (int i = 0; i < result.size; i++) {
+          for (int j = 0; j < 2; j++) {
+            result.waypoints[i][j].k[m] = k1.k[m];
           }
         }
       } else if (diff_in_coords[m] == 1) {
-        result[0][0].k[m] = k1.k[m];
-        result[0][1].k[m] = k1.k[m];
-        result[1][0].k[m] = k1.k[m];
-        result[1][1].k[m] = k1.k[m] + (k2.k[m] > k1.k[m]) - (k2.k[m] < k1.k[m]);
-        result[2][0].k[m] = k1.k[m] + (k2.k[m] > k1.k[m]) - (k2.k[m] < k1.k[m]);
-        result[2][1].k[m] = k1.k[m] + (k2.k[m] > k1.k[m]) - (k2.k[m] < k1.k[m]);
+        result.waypoints[0][0].k[m] = k1.k[m];
+        result.waypoints[0][1].k[m] = k1.k[m];
+        result.waypoints[1][0].k[m] = k1.k[m];
+        result.waypoints[1][1].k[m] = k1.k[m] + step;
+        result.waypoints[2][0].k[m] = k1.k[m] + step;
+        result.waypoints[2][1].k[m] = k1.k[m] + step;
       } else {
-        result[0][0].k[m] = k1.k[m] + (k2.k[m] > k1.k[m]) - (k2.k[m] < k1.k[m]);
-        result[0][1].k[m] = k1.k[m] + 2 * ((k2.k[m] > k1.k[m]) - (k2.k[m] < k1.k[m]));
-        result[1][0].k[m] = k1.k[m] + (k2.k[m] > k1.k[m]) - (k2.k[m] < k1.k[m]);
-        result[1][1].k[m] = k1.k[m] + (k2.k[m] > k1.k[m]) - (k2.k[m] < k1.k[m]);
-        result[2][0].k[m] = k1.k[m];
-        result[2][1].k[m] = k1.k[m] + (k2.k[m] > k1.k[m]) - (k2.k[m] < k1.k[m]);
+        result.waypoints[0][0].k[m] = k1.k[m] + step;
+        result.waypoints[0][1].k[m] = k1.k[m] + 2 * step;
+        result.waypoints[1][0].k[m] = k1.k[m] + step;
+        result.waypoints[1][1].k[m] = k1.k[m] + step;
+        result.waypoints[2][0].k[m] = k1.k[m];
+        result.waypoints[2][1].k[m] = k1.k[m] + step;
       }
     }
   }
-  return result;
 }
 //}
 
 /* getPossibleWaypointsForThreeDiffCoord() //{ */
-std::vector<std::vector<octomap::OcTreeKey>> AstarPlanner::getPossibleWaypointsForThreeDiffCoord(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2) {
-  std::vector<std::vector<octomap::OcTreeKey>> result;
-  result.resize(6);
-  for (uint i = 0; i < result.size(); i++) {
-    result[i].resize(2);
-  }
-  result[0][0].k[0] = k1.k[0] + (k2.k[0] > k1.k[0]) - (k2.k[0] < k1.k[0]);
-  result[0][0].k[1] = k1.k[1];
-  result[0][0].k[2] = k1.k[2];
-  result[0][1].k[0] = k1.k[0] + (k2.k[0] > k1.k[0]) - (k2.k[0] < k1.k[0]);
-  result[0][1].k[1] = k1.k[1] + (k2.k[1] > k1.k[1]) - (k2.k[1] < k1.k[1]);
-  result[0][1].k[2] = k1.k[2];
-  result[1][0]      = result[0][0];
-  result[1][1].k[0] = k1.k[0] + (k2.k[0] > k1.k[0]) - (k2.k[0] < k1.k[0]);
-  result[1][1].k[1] = k1.k[1];
-  result[1][1].k[2] = k1.k[2] + (k2.k[2] > k1.k[2]) - (k2.k[2] < k1.k[2]);
-  result[2][0].k[0] = k1.k[0];
-  result[2][0].k[1] = k1.k[1] + (k2.k[1] > k1.k[1]) - (k2.k[1] < k1.k[1]);
-  result[2][0].k[2] = k1.k[2];
-  result[2][1]      = result[0][1];
-  result[3][0]      = result[2][0];
-  result[3][1].k[0] = k1.k[0];
-  result[3][1].k[1] = k1.k[1] + (k2.k[1] > k1.k[1]) - (k2.k[1] < k1.k[1]);
-  result[3][1].k[2] = k1.k[2] + (k2.k[2] > k1.k[2]) - (k2.k[2] < k1.k[2]);
-  result[4][0].k[0] = k1.k[0];
-  result[4][0].k[1] = k1.k[1];
-  result[4][0].k[2] = k1.k[2] + (k2.k[2] > k1.k[2]) - (k2.k[2] < k1.k[2]);
-  result[4][1]      = result[1][1];
-  result[5][0]      = result[4][0];
-  result[5][1]      = result[3][1];
-  return result;
+void AstarPlanner::getPossibleWaypointsForThreeDiffCoord(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2, ConnectionCandidates& result) {
+  result.size   = 6;
+  result.length = 2;
+  octomap::OcTreeKey step_x = k1, step_y = k1, step_z = k1, step_xy = k1, step_xz = k1, step_yz = k1;
+  int                dx = (k2.k[0] > k1.k[0]) - (k2.k[0] < k1.k[0]);
+  int                dy = (k2.k[1] > k1.k[1]) - (k2.k[1] < k1.k[1]);
+  int                dz = (k2.k[2] > k1.k[2]) - (k2.k[2] < k1.k[2]);
+  step_x.k[0] += dx;
+  step_y.k[1] += dy;
+  step_z.k[2] += dz;
+  step_xy.k[0] += dx;
+  step_xy.k[1] += dy;
+  step_xz.k[0] += dx;
+  step_xz.k[2] += dz;
+  step_yz.k[1] += dy;
+  step_yz.k[2] += dz;
+  result.waypoints[0] = {step_x, step_xy};
+  result.waypoints[1] = {step_x, step_xz};
+  result.waypoints[2] = {step_y, step_xy};
+  result.waypoints[3] = {step_y, step_yz};
+  result.waypoints[4] = {step_z, step_xz};
+  result.waypoints[5] = {step_z, step_yz};
 }
 //}
 
@@ -1540,28 +3424,27 @@ octomap::OcTreeKey AstarPlanner::getConnectionNode(const octomap::OcTreeKey& k1,
 /* getConnectionNode3d() //{ */
 octomap::OcTreeKey AstarPlanner::getConnectionNode3d(const octomap::OcTreeKey& k1, const octomap::OcTreeKey& k2) {
   // returns best connection node for nodes with manhattan distance = 1
-  octomap::OcTreeKey              dir, diff, r1;
-  std::vector<octomap::OcTreeKey> results;
-  diff.k[0]              = abs(k2.k[0] - k1.k[0]);
-  diff.k[1]              = abs(k2.k[1] - k1.k[1]);
-  diff.k[2]              = abs(k2.k[2] - k1.k[2]);
-  int              dir_0 = k2.k[0] - k1.k[0] == 0 ? 0 : k2.k[0] - k1.k[0] > 0 ? 1 : -1;
-  int              dir_1 = k2.k[1] - k1.k[1] == 0 ? 0 : k2.k[1] - k1.k[1] > 0 ? 1 : -1;
-  int              dir_2 = k2.k[2] - k1.k[2] == 0 ? 0 : k2.k[2] - k1.k[2] > 0 ? 1 : -1;
-  std::vector<int> i0    = diff.k[0] == 0 ? idxs3d : diff.k[0] == 1 ? idxs2d : idxs1d;
-  std::vector<int> i1    = diff.k[1] == 0 ? idxs3d : diff.k[1] == 1 ? idxs2d : idxs1d;
-  std::vector<int> i2    = diff.k[2] == 0 ? idxs3d : diff.k[2] == 1 ? idxs2d : idxs1d;
-  for (size_t j = 0; j < i0.size(); j++) {
-    r1.k[0] = k2.k[0] + dir_0 * i0[j];
-    for (size_t k = 0; k < i1.size(); k++) {
-      r1.k[1] = k2.k[1] + dir_1 * i1[k];
-      for (size_t l = 0; l < i2.size(); l++) {
-        r1.k[2] = k2.k[2] + dir_2 * i2[l];
-        results.push_back(r1);
+  std::array<int, 3>                   dir;
+  std::array<const OneStepOffsets*, 3> offsets;
+  for (int m = 0; m < 3; m++) {
+    dir[m]     = (k2.k[m] > k1.k[m]) - (k2.k[m] < k1.k[m]);
+    offsets[m] = &one_step_offsets[std::min(abs(k2.k[m] - k1.k[m]), 2)];
+  }
+  ConnectionCandidates candidates;
+  candidates.length = 1;
+  octomap::OcTreeKey r1;
+  for (int j = 0; j < offsets[0]->size; j++) {
+    r1.k[0] = k2.k[0] + dir[0] * offsets[0]->offsets[j];
+    for (int k = 0; k < offsets[1]->size; k++) {
+      r1.k[1] = k2.k[1] + dir[1] * offsets[1]->offsets[k];
+      for (int l = 0; l < offsets[2]->size; l++) {
+        r1.k[2]                                  = k2.k[2] + dir[2] * offsets[2]->offsets[l];
+        candidates.waypoints[candidates.size][0] = r1;
+        candidates.size++;
       }
     }
   }
-  return getSafestWaypointsBetweenKeys(results);
+  return candidates.waypoints[getSafestConnectionCandidate(candidates)][0];
 }
 //}
 
@@ -1879,6 +3762,143 @@ void AstarPlanner::setAstarAdmissibility(const double astar_admissibility) {
 }
 //}
 
+/* setLazyCollisionChecking() //{ */
+void AstarPlanner::setLazyCollisionChecking(const bool lazy_collision_checking) {
+  lazy_collision_checking_ = lazy_collision_checking;
+  ROS_INFO("[AstarPlanner]: A* lazy collision checking %s", lazy_collision_checking_ ? "enabled" : "disabled");
+}
+//}
+
+/* setSamplingPlannerParams() //{ */
+void AstarPlanner::setSamplingPlannerParams(const double step_size, const double goal_bias, const int max_iterations) {
+  rrt_step_size_      = step_size;
+  rrt_goal_bias_      = goal_bias;
+  rrt_max_iterations_ = max_iterations;
+  ROS_INFO("[AstarPlanner]: Sampling planner params set: step size = %.2f, goal bias = %.2f, max iterations = %d", rrt_step_size_, rrt_goal_bias_,
+           rrt_max_iterations_);
+}
+//}
+
+/* setLatticeParams() //{ */
+void AstarPlanner::setLatticeParams(const int straight_primitive_length, const double goal_tolerance) {
+  lattice_straight_length_ = straight_primitive_length;
+  lattice_goal_tolerance_  = goal_tolerance;
+  initializeMotionPrimitives();
+  ROS_INFO("[AstarPlanner]: State lattice params set: straight primitive length = %d cells, goal tolerance = %.2f cells", lattice_straight_length_,
+           lattice_goal_tolerance_);
+}
+//}
+
+/* setCorridorGeneration() //{ */
+void AstarPlanner::setCorridorGeneration(const bool enable, const double max_box_size, const double obstacle_margin) {
+  corridor_generation_      = enable;
+  corridor_max_box_size_    = max_box_size;
+  corridor_obstacle_margin_ = obstacle_margin;
+  ROS_INFO("[AstarPlanner]: Corridor generation %s, max box size = %.2f, obstacle margin = %.2f", enable ? "enabled" : "disabled", max_box_size,
+           obstacle_margin);
+}
+//}
+
+/* setUnknownSpaceTraversal() //{ */
+void AstarPlanner::setUnknownSpaceTraversal(const bool enable, const double cost_factor) {
+  unknown_space_traversal_ = enable;
+  unknown_cost_factor_     = fmax(cost_factor, 1.0);  // lower factor would make the heuristic inadmissible
+  ROS_WARN_COND(cost_factor < 1.0, "[AstarPlanner]: Unknown space cost factor %.2f below 1.0, using 1.0", cost_factor);
+  ROS_INFO("[AstarPlanner]: Unknown space traversal %s, cost factor = %.2f", enable ? "enabled" : "disabled", unknown_cost_factor_);
+}
+//}
+
+/* setSearchMemoryBudget() //{ */
+void AstarPlanner::setSearchMemoryBudget(const size_t max_bytes, const double max_admissibility) {
+  search_memory_budget_            = max_bytes;
+  search_memory_max_admissibility_ = max_admissibility;
+  ROS_INFO("[AstarPlanner]: Search memory budget set to %lu B, max admissibility = %.2f", search_memory_budget_, search_memory_max_admissibility_);
+}
+//}
+
+/* setPerfCounters() //{ */
+void AstarPlanner::setPerfCounters(const bool enable) {
+  if (!enable) {
+    perf_counters_.close();
+    ROS_INFO("[AstarPlanner]: Hardware performance counters disabled");
+  } else if (perf_counters_.open()) {
+    ROS_INFO("[AstarPlanner]: Hardware performance counters enabled");
+  } else {
+    ROS_WARN("[AstarPlanner]: Hardware performance counters not available (check kernel.perf_event_paranoid), stats will not contain them");
+  }
+}
+//}
+
+/* setLatencyTarget() //{ */
+void AstarPlanner::setLatencyTarget(const double target_p95, const double max_admissibility, const int window_size) {
+  latency_target_            = target_p95;
+  latency_max_admissibility_ = std::max(max_admissibility, astar_admissibility_);
+  latency_window_size_       = std::max(window_size, 5);
+  tuned_admissibility_       = astar_admissibility_;
+  latency_window_.clear();
+  ROS_INFO("[AstarPlanner]: Latency target %s, p95 = %.3f s, max admissibility = %.2f, window = %d", target_p95 > 0.0 ? "enabled" : "disabled", target_p95,
+           latency_max_admissibility_, latency_window_size_);
+}
+//}
+
+/* setObstacleDecimation() //{ */
+void AstarPlanner::setObstacleDecimation(const double voxel_size, const double corridor_width) {
+  obstacle_decimation_voxel_size_     = voxel_size;
+  obstacle_decimation_corridor_width_ = corridor_width;
+  ROS_INFO("[AstarPlanner]: Obstacle decimation %s, voxel size = %.2f, corridor width = %.2f", voxel_size > 0.0 ? "enabled" : "disabled", voxel_size,
+           corridor_width);
+}
+//}
+
+/* setVerticalOscillationPenalty() //{ */
+void AstarPlanner::setVerticalOscillationPenalty(const double penalty) {
+  vertical_oscillation_penalty_ = penalty;
+  ROS_INFO("[AstarPlanner]: Vertical oscillation penalty set to %.2f", vertical_oscillation_penalty_);
+}
+//}
+
+/* setLayeredPlanningParams() //{ */
+void AstarPlanner::setLayeredPlanningParams(const std::vector<double>& layer_heights, const double max_ground_dist) {
+  layer_heights_ = layer_heights;
+  std::sort(layer_heights_.begin(), layer_heights_.end());
+  layered_max_ground_dist_ = max_ground_dist;
+  ROS_INFO("[AstarPlanner]: Layered planning params set: %lu layers, max ground dist = %.2f", layer_heights_.size(), layered_max_ground_dist_);
+}
+//}
+
+/* setSpeculativePlanningParams() //{ */
+void AstarPlanner::setSpeculativePlanningParams(const int max_threads, const double start_tolerance, const int cache_size) {
+  speculative_max_threads_     = std::max(1, max_threads);
+  speculative_start_tolerance_ = start_tolerance;
+  plan_cache_size_             = cache_size;
+  ROS_INFO("[AstarPlanner]: Speculative planning params set: max threads = %d, start tolerance = %.2f, cache size = %d", speculative_max_threads_,
+           speculative_start_tolerance_, plan_cache_size_);
+}
+//}
+
+/* setMapRevision() //{ */
+void AstarPlanner::setMapRevision(const uint64_t map_revision) {
+  map_revision_ = map_revision;
+  std::scoped_lock lock(plan_cache_mutex_);
+  plan_cache_.erase(std::remove_if(plan_cache_.begin(), plan_cache_.end(), [map_revision](const CachedPlan& p) { return p.map_revision != map_revision; }),
+                    plan_cache_.end());
+  ROS_INFO_COND(debug_, "[AstarPlanner]: Map revision set to %lu, %lu cached plans valid.", map_revision, plan_cache_.size());
+}
+//}
+
+/* setSensorOverlayParams() //{ */
+void AstarPlanner::setSensorOverlayParams(const double voxel_size, const double lifetime, const double max_query_dist) {
+  sensor_overlay_->setParams(voxel_size, lifetime, max_query_dist);
+  ROS_INFO("[AstarPlanner]: Sensor overlay params set: voxel size = %.2f, lifetime = %.2f, max query dist = %.2f", voxel_size, lifetime, max_query_dist);
+}
+//}
+
+/* insertSensorPoints() //{ */
+void AstarPlanner::insertSensorPoints(const std::vector<pcl::PointXYZ>& points, const ros::Time& stamp) {
+  sensor_overlay_->insertPoints(points, stamp);
+}
+//}
+
 /* SUPPORTING METHODS //{ */
 
 /* isNodeGoal() //{ */
@@ -1917,6 +3937,13 @@ double AstarPlanner::nodeDistance(const Node& a, const Node& b) {
 }
 //}
 
+/* isInInformedRegion() //{ */
+bool AstarPlanner::isInInformedRegion(const octomap::point3d& p, double inflation) {
+  // prolate spheroid with foci in start and goal, a point q within inflation of the spheroid satisfies |q - s| + |q - g| <= c + 2 * inflation
+  return p.distance(start_.pose) + p.distance(goal_.pose) <= cost_upper_bound_ + 2.0 * (inflation + sqrt(3.0) * resolution_);
+}
+//}
+
 /* isNodeInTheNeighborhood() //{ */
 bool AstarPlanner::isNodeInTheNeighborhood(const octomap::OcTreeKey& n, const octomap::OcTreeKey& center, double dist) {
   double voxel_dist = sqrt(pow(n.k[0] - center.k[0], 2) + pow(n.k[1] - center.k[1], 2) + pow(n.k[2] - center.k[2], 2));
@@ -1952,13 +3979,84 @@ void AstarPlanner::initializeIdxsOfcellsForPruning() {
   obs_diagonal_cond_              = getObstacleConditionsForDiagonalMove();
   obs_2d_diagonal_cond_           = getObstacleConditionsFor2dDiagonalMove();
   neighborhood_cube_              = getCubeForMoves();
-  idxs1                           = {{-1, -1}};
-  idxs2                           = {{-1, 0}, {0, -1}};
-  idxs3                           = {{-1, 0}, {0, -1}, {0, 0}, {-1, -1}};
-  idxs4                           = {{-1, 0}, {0, -1}, {1, 0}, {0, 1}, {0, 0}};
-  idxs1d                          = {-1};
-  idxs2d                          = {-1, 0};
-  idxs3d                          = {-1, 0, 1};
+}
+//}
+
+/* initializeMotionPrimitives() //{ */
+void AstarPlanner::initializeMotionPrimitives() {
+  // canonical primitives {end x, end y, end z, end heading} for east (axis) and north-east (diagonal) start heading, other headings are rotations by 90 deg
+  int                             l_axis = lattice_straight_length_;
+  int                             l_diag = std::max(1, int(round(lattice_straight_length_ / sqrt(2.0))));
+  std::vector<std::array<int, 4>> axis_primitives = {{l_axis, 0, 0, 0}, {l_axis, 0, 1, 0}, {l_axis, 0, -1, 0}, {3, 1, 0, 1}, {3, -1, 0, 7}};
+  std::vector<std::array<int, 4>> diag_primitives = {{l_diag, l_diag, 0, 1}, {l_diag, l_diag, 1, 1}, {l_diag, l_diag, -1, 1}, {1, 3, 0, 2}, {3, 1, 0, 0}};
+
+  motion_primitives_.clear();
+  motion_primitives_.resize(8);
+  size_t n_swept_voxels = 0;
+  for (int h = 0; h < 8; h++) {
+    int                              n_rotations = h / 2;
+    std::vector<std::array<int, 4>>& canonical   = h % 2 == 0 ? axis_primitives : diag_primitives;
+    for (auto& c : canonical) {
+      int x = c[0], y = c[1];
+      for (int r = 0; r < n_rotations; r++) {
+        int tmp = x;
+        x       = -y;
+        y       = tmp;
+      }
+      motion_primitives_[h].push_back(generateMotionPrimitive(h, (c[3] + 2 * n_rotations) % 8, {x, y, c[2]}));
+      n_swept_voxels += motion_primitives_[h].back().swept_offsets.size();
+    }
+  }
+  ROS_INFO_COND(verbose_, "[AstarPlanner]: %d motion primitives with %lu swept voxels generated.", 8 * int(axis_primitives.size()), n_swept_voxels);
+}
+//}
+
+/* generateMotionPrimitive() //{ */
+MotionPrimitive AstarPlanner::generateMotionPrimitive(int start_heading, int end_heading, const std::array<int, 3>& end_offset) {
+  // cubic Hermite curve in the horizontal plane with tangents given by the start and end heading, linear change of altitude
+  MotionPrimitive primitive;
+  primitive.start_heading = start_heading;
+  primitive.end_heading   = end_heading;
+  primitive.end_offset    = end_offset;
+  primitive.cost          = 0.0;
+
+  double chord    = sqrt(pow(end_offset[0], 2) + pow(end_offset[1], 2));
+  double t0_x     = chord * cos(start_heading * M_PI / 4.0);
+  double t0_y     = chord * sin(start_heading * M_PI / 4.0);
+  double t1_x     = chord * cos(end_heading * M_PI / 4.0);
+  double t1_y     = chord * sin(end_heading * M_PI / 4.0);
+  int    n_steps  = ceil(sqrt(pow(chord, 2) + pow(end_offset[2], 2)) / 0.05);
+  int    n_output = 4;  // number of output samples per primitive
+
+  std::array<int8_t, 3> last_offset = {0, 0, 0};
+  double                prev_x = 0.0, prev_y = 0.0, prev_z = 0.0;
+  for (int i = 1; i <= n_steps; i++) {
+    double s   = double(i) / n_steps;
+    double h10 = pow(s, 3) - 2 * pow(s, 2) + s;
+    double h01 = -2 * pow(s, 3) + 3 * pow(s, 2);
+    double h11 = pow(s, 3) - pow(s, 2);
+    double x   = h10 * t0_x + h01 * end_offset[0] + h11 * t1_x;
+    double y   = h10 * t0_y + h01 * end_offset[1] + h11 * t1_y;
+    double z   = s * end_offset[2];
+    primitive.cost += sqrt(pow(x - prev_x, 2) + pow(y - prev_y, 2) + pow(z - prev_z, 2));
+    prev_x = x;
+    prev_y = y;
+    prev_z = z;
+
+    std::array<int8_t, 3> offset = {int8_t(round(x)), int8_t(round(y)), int8_t(round(z))};
+    if (offset != last_offset && std::find(primitive.swept_offsets.begin(), primitive.swept_offsets.end(), offset) == primitive.swept_offsets.end()) {
+      primitive.swept_offsets.push_back(offset);
+    }
+    last_offset = offset;
+
+    if (i % std::max(1, n_steps / n_output) == 0 || i == n_steps) {
+      primitive.samples.push_back({float(x), float(y), float(z)});
+    }
+  }
+  if (primitive.samples.size() > 1 && primitive.samples[primitive.samples.size() - 2] == primitive.samples.back()) {
+    primitive.samples.pop_back();
+  }
+  return primitive;
 }
 //}
 
@@ -2292,6 +4390,7 @@ int AstarPlanner::isConnectivityMaintained(const octomap::OcTreeKey& k1, const o
 /* setPlanningOctree() //{ */
 void AstarPlanner::setPlanningOctree(std::shared_ptr<octomap::OcTree> new_map) {
   planning_octree_ = new_map;
+  octree_lookup_cache_.clear();
 }
 //}
 
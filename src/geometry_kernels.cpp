@@ -0,0 +1,43 @@
+#include <cmath>
+#include "mrs_subt_planning_lib/geometry_kernels.h"
+
+using namespace mrs_subt_planning;
+
+/* getMinSquaredDistance() //{ */
+MRS_SUBT_PLANNING_MULTIVERSIONED
+float mrs_subt_planning::getMinSquaredDistance(const pcl::PointXYZ* points, size_t n_points, const pcl::PointXYZ& query, float max_sqr_dist) {
+  float min_sqr_dist = max_sqr_dist;
+#pragma omp simd reduction(min : min_sqr_dist)
+  for (size_t i = 0; i < n_points; i++) {
+    float dx     = points[i].x - query.x;
+    float dy     = points[i].y - query.y;
+    float dz     = points[i].z - query.z;
+    min_sqr_dist = std::fmin(min_sqr_dist, dx * dx + dy * dy + dz * dz);
+  }
+  return min_sqr_dist;
+}
+//}
+
+/* getDistancesToSegment() //{ */
+MRS_SUBT_PLANNING_MULTIVERSIONED
+void mrs_subt_planning::getDistancesToSegment(const pcl::PointXYZ* points, size_t n_points, const pcl::PointXYZ& start, const pcl::PointXYZ& end,
+                                              float* distances) {
+  float sx           = end.x - start.x;
+  float sy           = end.y - start.y;
+  float sz           = end.z - start.z;
+  float seg_len2     = sx * sx + sy * sy + sz * sz;
+  float inv_seg_len2 = seg_len2 > 0.0f ? 1.0f / seg_len2 : 0.0f;  // degenerate segment is its start point
+#pragma omp simd
+  for (size_t i = 0; i < n_points; i++) {
+    float qx = points[i].x - start.x;
+    float qy = points[i].y - start.y;
+    float qz = points[i].z - start.z;
+    float t  = std::fmin(std::fmax((qx * sx + qy * sy + qz * sz) * inv_seg_len2, 0.0f), 1.0f);
+    float dx = qx - t * sx;
+    float dy = qy - t * sy;
+    float dz = qz - t * sz;
+
+    distances[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+  }
+}
+//}
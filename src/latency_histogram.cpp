@@ -0,0 +1,118 @@
+#include "mrs_subt_planning_lib/latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+using namespace mrs_subt_planning;
+
+LatencyHistogram::LatencyHistogram() {
+  reset();
+}
+
+/* record() //{ */
+void LatencyHistogram::record(double latency) {
+  uint64_t value = latency > 0.0 ? uint64_t(llround(latency * 1e6)) : 0;
+  buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+//}
+
+/* reset() //{ */
+void LatencyHistogram::reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+//}
+
+/* getCount() //{ */
+uint64_t LatencyHistogram::getCount() const {
+  return count_.load(std::memory_order_relaxed);
+}
+//}
+
+/* getMean() //{ */
+double LatencyHistogram::getMean() const {
+  uint64_t count = getCount();
+  return count > 0 ? sum_.load(std::memory_order_relaxed) * 1e-6 / count : 0.0;
+}
+//}
+
+/* getMax() //{ */
+double LatencyHistogram::getMax() const {
+  return max_.load(std::memory_order_relaxed) * 1e-6;
+}
+//}
+
+/* getPercentile() //{ */
+double LatencyHistogram::getPercentile(double percentile) const {
+  uint64_t total = 0;
+  for (auto& bucket : buckets_) {
+    total += bucket.load(std::memory_order_relaxed);
+  }
+  if (total == 0) {
+    return 0.0;
+  }
+  uint64_t target     = std::max(uint64_t(1), uint64_t(ceil(percentile / 100.0 * total)));
+  uint64_t cumulative = 0;
+  for (int i = 0; i < N_BUCKETS; i++) {
+    cumulative += buckets_[i].load(std::memory_order_relaxed);
+    if (cumulative >= target) {
+      return std::min(bucketMidpoint(i), max_.load(std::memory_order_relaxed)) * 1e-6;
+    }
+  }
+  return getMax();
+}
+//}
+
+/* toString() //{ */
+std::string LatencyHistogram::toString() const {
+  char buffer[256];
+  snprintf(buffer, sizeof(buffer), "n=%lu mean=%.2f p50=%.2f p90=%.2f p99=%.2f p99.9=%.2f max=%.2f ms", getCount(), getMean() * 1e3, getPercentile(50.0) * 1e3,
+           getPercentile(90.0) * 1e3, getPercentile(99.0) * 1e3, getPercentile(99.9) * 1e3, getMax() * 1e3);
+  return std::string(buffer);
+}
+//}
+
+/* toJson() //{ */
+std::string LatencyHistogram::toJson() const {
+  char buffer[256];
+  snprintf(buffer, sizeof(buffer), "{\"count\": %lu, \"mean_ms\": %.3f, \"p50_ms\": %.3f, \"p90_ms\": %.3f, \"p99_ms\": %.3f, \"p999_ms\": %.3f, \"max_ms\": %.3f}",
+           getCount(), getMean() * 1e3, getPercentile(50.0) * 1e3, getPercentile(90.0) * 1e3, getPercentile(99.0) * 1e3, getPercentile(99.9) * 1e3,
+           getMax() * 1e3);
+  return std::string(buffer);
+}
+//}
+
+/* bucketIndex() //{ */
+int LatencyHistogram::bucketIndex(uint64_t value) {
+  value = std::min(value, (uint64_t(1) << MAX_BITS) - 1);  // longer latencies are stored in the last bucket
+  if (value < uint64_t(N_LINEAR)) {
+    return int(value);
+  }
+  int msb   = 63 - __builtin_clzll(value);
+  int shift = msb - SUB_BUCKET_BITS;
+  int top   = int(value >> shift);  // in [2^SUB_BUCKET_BITS, 2^(SUB_BUCKET_BITS + 1))
+  return N_LINEAR + (msb - SUB_BUCKET_BITS - 1) * (1 << SUB_BUCKET_BITS) + (top - (1 << SUB_BUCKET_BITS));
+}
+//}
+
+/* bucketMidpoint() //{ */
+uint64_t LatencyHistogram::bucketMidpoint(int index) {
+  if (index < N_LINEAR) {
+    return index;
+  }
+  int k     = index - N_LINEAR;
+  int msb   = k / (1 << SUB_BUCKET_BITS) + SUB_BUCKET_BITS + 1;
+  int top   = k % (1 << SUB_BUCKET_BITS) + (1 << SUB_BUCKET_BITS);
+  int shift = msb - SUB_BUCKET_BITS;
+  return (uint64_t(top) << shift) + (uint64_t(1) << shift) / 2;
+}
+//}
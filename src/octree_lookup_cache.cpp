@@ -0,0 +1,79 @@
+#include "mrs_subt_planning_lib/octree_lookup_cache.h"
+
+using namespace mrs_subt_planning;
+
+OcTreeLookupCache::OcTreeLookupCache() {
+  octree_ = NULL;
+  hits_   = 0;
+  misses_ = 0;
+  clear();
+}
+
+/* search() //{ */
+octomap::OcTreeNode* OcTreeLookupCache::search(const octomap::OcTree* octree, const octomap::OcTreeKey& key) {
+  if (octree != octree_) {
+    clear();
+    octree_ = octree;
+  }
+
+  for (const Entry& e : entries_) {
+    // unsigned arithmetic, keys below the minimum wrap around to large values
+    if (unsigned(key.k[0] - e.min.k[0]) < e.size && unsigned(key.k[1] - e.min.k[1]) < e.size && unsigned(key.k[2] - e.min.k[2]) < e.size) {
+      hits_++;
+      return e.node;
+    }
+  }
+  misses_++;
+
+  if (octree == NULL || octree->getRoot() == NULL) {
+    return NULL;
+  }
+
+  // same descent as OcTree::search(), the level of the final node is kept to get its extent
+  octomap::OcTreeNode* node  = octree->getRoot();
+  int                  level = octree->getTreeDepth();  // node covers 2^level keys along each axis
+  while (level > 0) {
+    unsigned int child_idx = octomap::computeChildIdx(key, level - 1);
+    if (octree->nodeChildExists(node, child_idx)) {
+      node = octree->getNodeChild(node, child_idx);
+      level--;
+    } else {
+      if (octree->nodeHasChildren(node)) {  // missing child of an inner node is an unknown region
+        node = NULL;
+        level--;
+      }
+      break;
+    }
+  }
+
+  Entry& e = entries_[next_entry_];
+  e.size   = 1u << level;
+  for (int i = 0; i < 3; i++) {
+    e.min.k[i] = key.k[i] & ~(e.size - 1);
+  }
+  e.node      = node;
+  next_entry_ = (next_entry_ + 1) % CAPACITY;
+  return node;
+}
+//}
+
+/* clear() //{ */
+void OcTreeLookupCache::clear() {
+  for (Entry& e : entries_) {
+    e.size = 0;
+  }
+  next_entry_ = 0;
+}
+//}
+
+/* getNumberOfHits() //{ */
+uint64_t OcTreeLookupCache::getNumberOfHits() {
+  return hits_;
+}
+//}
+
+/* getNumberOfMisses() //{ */
+uint64_t OcTreeLookupCache::getNumberOfMisses() {
+  return misses_;
+}
+//}
@@ -1,5 +1,6 @@
 #include <ros/ros.h>
 #include <mrs_subt_planning_lib/pcl_map.h>
+#include <mrs_subt_planning_lib/geometry_kernels.h>
 
 using namespace mrs_subt_planning;
 
@@ -111,6 +112,8 @@ void PCLMap::initKDTreeSearch(pcl::PointCloud<pcl::PointXYZ>::Ptr points) {
   /* kdtree->setInputCloud(zero_points); */
   /* kdtree->reset(); */
   pcl_cloud = points; // FIXME: unnecessarry if not using check distance from nearest point
+  kd_tree_initialized        = false;
+  coarse_kd_tree_initialized = false;  // decimated obstacles belong to the previous map
 
   if (points->size() > 0) {
     /* ROS_INFO("[%s]: initkdtree, point size = %lu", ros::this_node::getName().c_str(), points->size()); */
@@ -121,16 +124,40 @@ void PCLMap::initKDTreeSearch(pcl::PointCloud<pcl::PointXYZ>::Ptr points) {
   ROS_INFO("[%s]: init kd tree search end", ros::this_node::getName().c_str());
 }
 
+void PCLMap::initOctreeSearch(pcl::PointCloud<pcl::PointXYZ>::Ptr points) {
+  octree->deleteTree();
+  octree->setInputCloud(points);
+  octree->addPointsFromInputCloud();
+  pcl_cloud = points;
+}
+
 double PCLMap::getDistanceFromNearestPoint(pcl::PointXYZ point) {
-  std::vector<int>   indices(1);
-  std::vector<float> sqr_distances(1);
+  double overlay_dist = sensor_overlay_ ? sensor_overlay_->getDistanceFromNearestPoint(point) : FLT_MAX;
+  return fmin(getKDTreeDistance(point), overlay_dist);
+}
 
+void PCLMap::initCoarseKDTreeSearch(pcl::PointCloud<pcl::PointXYZ>::Ptr points, double max_error) {
+  coarse_kd_tree_initialized = false;
+  coarse_max_error           = max_error;
+  if (points->size() > 0) {
+    coarse_kdtree = pcl::KdTreeFLANN<pcl::PointXYZ>::Ptr(new pcl::KdTreeFLANN<pcl::PointXYZ>);
+    coarse_kdtree->setInputCloud(points);
+    coarse_kd_tree_initialized = true;
+  }
+}
+
+double PCLMap::getKDTreeDistance(const pcl::PointXYZ &point) {
+  // search buffers are reused between calls, nearestKSearch only resizes them
+  thread_local std::vector<int>   indices(1);
+  thread_local std::vector<float> sqr_distances(1);
+  double                          dist = FLT_MAX;
   if (kd_tree_initialized && kdtree->nearestKSearch(point, 1, indices, sqr_distances) > 0) {
-    /* ROS_INFO("[%s]: Nearest point search: returning %.2f", ros::this_node::getName().c_str(), sqrt(sqr_distances[0])); */
-    return sqrt(sqr_distances[0]);
-  } else {
-    return FLT_MAX;
+    dist = sqrt(sqr_distances[0]);
   }
+  if (coarse_kd_tree_initialized && coarse_kdtree->nearestKSearch(point, 1, indices, sqr_distances) > 0) {
+    dist = fmin(dist, fmax(sqrt(sqr_distances[0]) - coarse_max_error, 0.0));  // lower bound of the distance to the decimated obstacles
+  }
+  return dist;
 }
 
 bool PCLMap::checkDistanceFromNearestPoint(pcl::PointXYZ point, double safe_dist_xy, double safe_dist_z) {
@@ -154,6 +181,29 @@ bool PCLMap::checkDistanceFromNearestPoint(pcl::PointXYZ point, double safe_dist
   }
 }
 
+bool PCLMap::arePointsInSafeDistance(const std::vector<pcl::PointXYZ> &points, double safe_dist) {
+  for (const pcl::PointXYZ &point : points) {
+    if (sensor_overlay_ && sensor_overlay_->getDistanceFromNearestPoint(point) < safe_dist) {
+      return false;
+    }
+    if (getKDTreeDistance(point) < safe_dist) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PCLMap::getDistancesFromNearestPoints(const pcl::PointXYZ *points, size_t n_points, double *distances) {
+  for (size_t i = 0; i < n_points; i++) {
+    distances[i] = sensor_overlay_ ? sensor_overlay_->getDistanceFromNearestPoint(points[i]) : FLT_MAX;
+    distances[i] = fmin(getKDTreeDistance(points[i]), distances[i]);
+  }
+}
+
+void PCLMap::setSensorOverlay(std::shared_ptr<SensorOverlay> sensor_overlay) {
+  sensor_overlay_ = sensor_overlay;
+}
+
 pcl::PointCloud<pcl::PointXYZ>::Ptr PCLMap::octomapToPointcloud(std::shared_ptr<octomap::OcTree> input_octree, std::array<octomap::point3d, 2> map_limits, bool ignore_unknown_cells) {
   std::vector<pcl::PointXYZ> output_pcl;
 
@@ -166,6 +216,7 @@ pcl::PointCloud<pcl::PointXYZ>::Ptr PCLMap::octomapToPointcloud(std::shared_ptr<
     ROS_ERROR("[PCL map]: Octomap cannot be converted. Empty input octree received."); // FIXME add retunr
   }
 
+  OcTreeLookupCache  octree_cache;  // neighboring cells mostly share a coarse leaf
   octomap::OcTreeKey min_key = input_octree->coordToKey(map_limits[0]);
   octomap::OcTreeKey max_key = input_octree->coordToKey(map_limits[1]);
   for (int x = min_key.k[0]; x <= max_key.k[0]; x++) {
@@ -176,8 +227,8 @@ pcl::PointCloud<pcl::PointXYZ>::Ptr PCLMap::octomapToPointcloud(std::shared_ptr<
         tmp_key.k[0] = x;
         tmp_key.k[1] = y;
         tmp_key.k[2] = z;
-        if ((!ignore_unknown_cells && input_octree->search(tmp_key) == NULL) ||
-            (input_octree->search(tmp_key) != NULL && input_octree->isNodeOccupied(input_octree->search(tmp_key)))) {
+        octomap::OcTreeNode* node = octree_cache.search(input_octree.get(), tmp_key);
+        if ((!ignore_unknown_cells && node == NULL) || (node != NULL && input_octree->isNodeOccupied(node))) {
           octomap::point3d octomap_point = input_octree->keyToCoord(tmp_key);
           point.x                        = octomap_point.x();
           point.y                        = octomap_point.y();
@@ -195,3 +246,101 @@ pcl::PointCloud<pcl::PointXYZ>::Ptr PCLMap::octomapToPointcloud(std::shared_ptr<
   ROS_ERROR("[PCL map]: Octomap cannot be converted empty pointcloud received.");
   return nullptr;
 }
+
+SensorOverlay::SensorOverlay(double voxel_size, double lifetime, double max_query_dist) {
+  setParams(voxel_size, lifetime, max_query_dist);
+}
+
+void SensorOverlay::setParams(double voxel_size, double lifetime, double max_query_dist) {
+  voxel_size_     = voxel_size;
+  lifetime_       = lifetime;
+  max_query_dist_ = max_query_dist;
+  buckets_.clear();  // rebuilt with the new bucket size in the next update
+  for (auto &v : voxels_) {
+    buckets_[cellId(v.second.point, max_query_dist_)].push_back(v.second.point);
+  }
+}
+
+void SensorOverlay::insertPoints(const std::vector<pcl::PointXYZ> &points, const ros::Time &stamp) {
+  std::scoped_lock lock(pending_mutex_);
+  for (auto &p : points) {
+    pending_points_.push_back(std::make_pair(p, stamp));
+  }
+}
+
+void SensorOverlay::update(const ros::Time &now) {
+  std::vector<std::pair<pcl::PointXYZ, ros::Time>> new_points;
+  {
+    std::scoped_lock lock(pending_mutex_);
+    new_points.swap(pending_points_);
+  }
+
+  bool changed = !new_points.empty();
+  for (auto &p : new_points) {
+    OverlayPoint &v = voxels_[cellId(p.first, voxel_size_)];
+    if (v.stamp <= p.second) {
+      v.point = p.first;
+      v.stamp = p.second;
+    }
+  }
+
+  for (auto it = voxels_.begin(); it != voxels_.end();) {
+    if ((now - it->second.stamp).toSec() > lifetime_) {
+      it      = voxels_.erase(it);
+      changed = true;
+    } else {
+      ++it;
+    }
+  }
+
+  if (changed) {
+    buckets_.clear();
+    for (auto &v : voxels_) {
+      buckets_[cellId(v.second.point, max_query_dist_)].push_back(v.second.point);
+    }
+  }
+}
+
+double SensorOverlay::getDistanceFromNearestPoint(const pcl::PointXYZ &point) {
+  if (buckets_.empty()) {
+    return FLT_MAX;
+  }
+  // buckets have the size of max_query_dist_, all points closer than max_query_dist_ are in the 27 surrounding buckets
+  int   bx           = floor(point.x / max_query_dist_);
+  int   by           = floor(point.y / max_query_dist_);
+  int   bz           = floor(point.z / max_query_dist_);
+  float max_sqr_dist = max_query_dist_ * max_query_dist_;
+  float min_sqr_dist = max_sqr_dist;
+  for (int x = bx - 1; x <= bx + 1; x++) {
+    for (int y = by - 1; y <= by + 1; y++) {
+      for (int z = bz - 1; z <= bz + 1; z++) {
+        auto it = buckets_.find(cellId(x, y, z));
+        if (it == buckets_.end()) {
+          continue;
+        }
+        min_sqr_dist = getMinSquaredDistance(it->second.data(), it->second.size(), point, min_sqr_dist);
+      }
+    }
+  }
+  return min_sqr_dist < max_sqr_dist ? sqrt(min_sqr_dist) : FLT_MAX;
+}
+
+size_t SensorOverlay::size() {
+  return voxels_.size();
+}
+
+void SensorOverlay::clear() {
+  std::scoped_lock lock(pending_mutex_);
+  pending_points_.clear();
+  voxels_.clear();
+  buckets_.clear();
+}
+
+uint64_t SensorOverlay::cellId(const pcl::PointXYZ &point, double cell_size) {
+  return cellId(floor(point.x / cell_size), floor(point.y / cell_size), floor(point.z / cell_size));
+}
+
+uint64_t SensorOverlay::cellId(int x, int y, int z) {
+  // 21 bits per coordinate
+  return (uint64_t(x & 0x1FFFFF) << 42) | (uint64_t(y & 0x1FFFFF) << 21) | uint64_t(z & 0x1FFFFF);
+}
@@ -0,0 +1,124 @@
+/* Cost of the obstacle queries of PCLMap and SensorOverlay versus cloud size, query locality and search radius.
+ *
+ * Usage: pcl_map_benchmark [n_queries] [cloud.pcd]
+ *
+ * Without a PCD file, clouds of 10k, 100k and 1M points sampled uniformly in a 100 x 100 x 20 m box are used.
+ * Build time of every index is printed for every cloud, ns/query of every query for random queries in the bounds of the cloud
+ * and for local queries following a random walk with 0.1 m steps, as queries of the planner are.
+ */
+
+#include <chrono>
+#include <random>
+#include <mrs_subt_planning_lib/pcl_map.h>
+
+using namespace mrs_subt_planning;
+
+typedef std::chrono::steady_clock Clock;
+
+double sink = 0.0;  // results of the queries, keeps the compiler from removing them
+
+template <typename Function>
+double elapsedMs(Function function) {
+  auto t_start = Clock::now();
+  function();
+  return std::chrono::duration<double, std::milli>(Clock::now() - t_start).count();
+}
+
+template <typename Query>
+double nsPerQuery(const std::vector<pcl::PointXYZ>& points, Query query) {
+  auto t_start = Clock::now();
+  for (const auto& p : points) {
+    sink += query(p);
+  }
+  return std::chrono::duration<double, std::nano>(Clock::now() - t_start).count() / points.size();
+}
+
+std::vector<pcl::PointXYZ> getQueryPoints(const pcl::PointXYZ& min, const pcl::PointXYZ& max, size_t n_queries, bool local, std::mt19937& generator) {
+  std::uniform_real_distribution<float> ux(min.x, max.x), uy(min.y, max.y), uz(min.z, max.z), step(-0.1, 0.1);
+  std::vector<pcl::PointXYZ>            points;
+  pcl::PointXYZ                         p(ux(generator), uy(generator), uz(generator));
+  for (size_t k = 0; k < n_queries; k++) {
+    if (local) {
+      p = pcl::PointXYZ(std::clamp(p.x + step(generator), min.x, max.x), std::clamp(p.y + step(generator), min.y, max.y),
+                        std::clamp(p.z + step(generator), min.z, max.z));
+    } else {
+      p = pcl::PointXYZ(ux(generator), uy(generator), uz(generator));
+    }
+    points.push_back(p);
+  }
+  return points;
+}
+
+int main(int argc, char** argv) {
+
+  ros::Time::init();
+
+  size_t       n_queries = argc > 1 ? std::stoul(argv[1]) : 100000;
+  std::mt19937 generator(0);
+
+  std::vector<pcl::PointCloud<pcl::PointXYZ>::Ptr> clouds;
+  if (argc > 2) {
+    pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+    if (pcl::io::loadPCDFile<pcl::PointXYZ>(argv[2], *cloud) == -1 || cloud->empty()) {
+      std::cerr << "Cannot load points from " << argv[2] << std::endl;
+      return 1;
+    }
+    clouds.push_back(cloud);
+  } else {
+    std::uniform_real_distribution<float> ux(0.0, 100.0), uy(0.0, 100.0), uz(0.0, 20.0);
+    for (size_t size : {10000, 100000, 1000000}) {
+      std::vector<pcl::PointXYZ> points;
+      for (size_t k = 0; k < size; k++) {
+        points.push_back(pcl::PointXYZ(ux(generator), uy(generator), uz(generator)));
+      }
+      clouds.push_back(PCLMap::pclVectorToPointcloud(points));
+    }
+  }
+
+  std::vector<double> radii = {0.5, 1.0, 2.0};
+
+  for (auto& cloud : clouds) {
+    pcl::PointXYZ min(FLT_MAX, FLT_MAX, FLT_MAX), max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (const auto& p : cloud->points) {
+      min = pcl::PointXYZ(fmin(min.x, p.x), fmin(min.y, p.y), fmin(min.z, p.z));
+      max = pcl::PointXYZ(fmax(max.x, p.x), fmax(max.y, p.y), fmax(max.z, p.z));
+    }
+
+    std::vector<pcl::PointXYZ> cloud_points(cloud->begin(), cloud->end());
+    PCLMap                     pcl_map;
+
+    double octree_build_ms = elapsedMs([&]() { pcl_map.initOctreeSearch(cloud); });
+    double kdtree_build_ms = elapsedMs([&]() { pcl_map.initKDTreeSearch(cloud); });
+    printf("\ncloud of %lu points, build: pcl octree %.1f ms, kd tree %.1f ms\n", cloud->size(), octree_build_ms, kdtree_build_ms);
+
+    printf("%-8s %8s %14s %14s %14s %14s %14s %14s %14s\n", "queries", "radius", "octree radius", "octree cyl.", "kd nearest", "kd batch", "kd check",
+           "hash build ms", "hash nearest");
+    for (bool local : {false, true}) {
+      std::vector<pcl::PointXYZ> points = getQueryPoints(min, max, n_queries, local, generator);
+      for (double radius : radii) {
+        // spatial hash of the sensor overlay, 1 cm voxels keep nearly all points, queries are bounded by its max query distance
+        SensorOverlay overlay(0.01, 1e9, radius);
+        double        hash_build_ms = elapsedMs([&]() {
+          overlay.insertPoints(cloud_points, ros::Time::now());
+          overlay.update(ros::Time::now());
+        });
+
+        double octree_radius = nsPerQuery(points, [&](const pcl::PointXYZ& p) { return pcl_map.radiusSearch(p.x, p.y, p.z, radius); });
+        double octree_cyl    = nsPerQuery(points, [&](const pcl::PointXYZ& p) { return pcl_map.simulatedCyllinderSearch(p.x, p.y, p.z, radius, min.z, 0.3); });
+        double kd_nearest    = nsPerQuery(points, [&](const pcl::PointXYZ& p) { return pcl_map.getDistanceFromNearestPoint(p); });
+        double kd_check      = nsPerQuery(points, [&](const pcl::PointXYZ& p) { return pcl_map.checkDistanceFromNearestPoint(p, radius, 0.5 * radius); });
+        double hash_nearest  = nsPerQuery(points, [&](const pcl::PointXYZ& p) { return overlay.getDistanceFromNearestPoint(p); });
+
+        std::vector<double> distances(points.size());
+        double              kd_batch = elapsedMs([&]() { pcl_map.getDistancesFromNearestPoints(points.data(), points.size(), distances.data()); }) * 1e6 / points.size();
+        sink += distances.back();
+
+        printf("%-8s %8.1f %14.0f %14.0f %14.0f %14.0f %14.0f %14.1f %14.0f\n", local ? "local" : "random", radius, octree_radius, octree_cyl, kd_nearest,
+               kd_batch, kd_check, hash_build_ms, hash_nearest);
+      }
+    }
+  }
+
+  printf("\n(checksum %g)\n", sink);
+  return 0;
+}
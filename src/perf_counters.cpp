@@ -0,0 +1,109 @@
+#include "mrs_subt_planning_lib/perf_counters.h"
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace mrs_subt_planning;
+
+PerfCounters::PerfCounters() {
+  fds_.fill(-1);
+  owner_tid_ = -1;
+}
+
+PerfCounters::~PerfCounters() {
+  close();
+}
+
+/* open() //{ */
+bool PerfCounters::open() {
+#ifdef __linux__
+  if (isOpen()) {
+    return true;
+  }
+  const std::array<uint64_t, 4> events = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+  for (size_t i = 0; i < events.size(); i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = events[i];
+    attr.disabled       = i == 0;  // the group is enabled and disabled through its leader
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP;
+    fds_[i]             = syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds_[0], 0);  // calling thread, any cpu
+    if (fds_[i] < 0) {
+      close();
+      return false;
+    }
+  }
+  owner_tid_ = syscall(SYS_gettid);
+  return true;
+#else
+  return false;
+#endif
+}
+//}
+
+/* close() //{ */
+void PerfCounters::close() {
+#ifdef __linux__
+  for (int& fd : fds_) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    fd = -1;
+  }
+#endif
+}
+//}
+
+/* isOpen() //{ */
+bool PerfCounters::isOpen() {
+  return fds_[0] >= 0;
+}
+//}
+
+/* start() //{ */
+void PerfCounters::start() {
+#ifdef __linux__
+  if (!isOpen()) {
+    return;
+  }
+  if (syscall(SYS_gettid) != owner_tid_) {  // e.g. enabled in the configuring thread, planning runs in a callback thread
+    close();
+    if (!open()) {
+      return;
+    }
+  }
+  ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+//}
+
+/* stop() //{ */
+PerfCounterValues PerfCounters::stop() {
+  PerfCounterValues values;
+#ifdef __linux__
+  if (!isOpen() || syscall(SYS_gettid) != owner_tid_) {  // counts of another thread
+    return values;
+  }
+  ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  uint64_t data[1 + 4];  // number of events followed by their values in the order of opening
+  if (read(fds_[0], data, sizeof(data)) == ssize_t(sizeof(data)) && data[0] == 4) {
+    values.cycles        = data[1];
+    values.instructions  = data[2];
+    values.llc_misses    = data[3];
+    values.branch_misses = data[4];
+    values.valid         = true;
+  }
+#endif
+  return values;
+}
+//}
@@ -0,0 +1,101 @@
+/* Comparison of the planning engines on recorded maps.
+ *
+ * Usage: planner_benchmark <map.bt> <queries.txt> [safe_dist] [planning_timeout]
+ *
+ * Every line of the queries file contains start and goal coordinates "sx sy sz gx gy gz".
+ * Each query is planned by all engines and the planning time, path length and number of waypoints are printed.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <mrs_subt_planning_lib/astar_planner.h>
+
+using namespace mrs_subt_planning;
+
+struct QueryResult
+{
+  double time_ms      = 0.0;
+  double path_length  = 0.0;
+  size_t n_waypoints  = 0;
+  bool   goal_reached = false;
+};
+
+double pathLength(const std::vector<octomap::point3d>& path) {
+  double length = 0.0;
+  for (size_t k = 1; k < path.size(); k++) {
+    length += path[k].distance(path[k - 1]);
+  }
+  return length;
+}
+
+QueryResult runQuery(AstarPlanner& planner, std::shared_ptr<octomap::OcTree> octree, const octomap::point3d& start, const octomap::point3d& goal,
+                     double safe_dist, PlanningEngine engine) {
+  QueryResult result;
+  bool        grid_path = engine == PlanningEngine::ASTAR || engine == PlanningEngine::LAYERED;  // postprocessing is applicable to connected key paths only
+  auto        t_start   = std::chrono::steady_clock::now();
+  auto path = planner.findPath(start, goal, octree, false, grid_path, 0.0, 0.0, safe_dist, 5, false, 0.3, 5, 1.0, true, 0.3, false, 2.0, -1.0, engine);
+  result.time_ms      = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count();
+  result.path_length  = pathLength(path.first);
+  result.n_waypoints  = path.first.size();
+  result.goal_reached = !path.first.empty() && path.first.back().distance(goal) < 2.0 * octree->getResolution();
+  return result;
+}
+
+int main(int argc, char** argv) {
+
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <map.bt> <queries.txt> [safe_dist] [planning_timeout]" << std::endl;
+    return 1;
+  }
+
+  ros::Time::init();
+
+  double safe_dist        = argc > 3 ? std::stod(argv[3]) : 1.0;
+  double planning_timeout = argc > 4 ? std::stod(argv[4]) : 5.0;
+
+  std::shared_ptr<octomap::OcTree> octree = std::make_shared<octomap::OcTree>(std::string(argv[1]));
+  double                           min_x, min_y, min_z, max_x, max_y, max_z;
+  octree->getMetricMin(min_x, min_y, min_z);
+  octree->getMetricMax(max_x, max_y, max_z);
+
+  std::vector<std::pair<octomap::point3d, octomap::point3d>> queries;
+  std::ifstream                                              queries_file(argv[2]);
+  std::string                                                line;
+  while (std::getline(queries_file, line)) {
+    std::istringstream ss(line);
+    double             sx, sy, sz, gx, gy, gz;
+    if (ss >> sx >> sy >> sz >> gx >> gy >> gz) {
+      queries.push_back(std::make_pair(octomap::point3d(sx, sy, sz), octomap::point3d(gx, gy, gz)));
+    }
+  }
+
+  if (queries.empty()) {
+    std::cerr << "No queries loaded from " << argv[2] << std::endl;
+    return 1;
+  }
+
+  std::vector<std::pair<std::string, PlanningEngine>> engines = {
+      {"astar", PlanningEngine::ASTAR}, {"informed_rrt_star", PlanningEngine::INFORMED_RRT_STAR}, {"state_lattice", PlanningEngine::STATE_LATTICE},
+      {"layered", PlanningEngine::LAYERED}};
+
+  printf("%-6s %-18s %12s %12s %10s %8s\n", "query", "engine", "time [ms]", "length [m]", "waypoints", "reached");
+  for (auto& engine : engines) {
+    AstarPlanner planner;
+    planner.initialize(true, planning_timeout, safe_dist, safe_dist, min_z, max_z, false, nullptr);
+
+    double time_sum = 0.0, length_sum = 0.0;
+    int    n_reached = 0;
+    for (size_t k = 0; k < queries.size(); k++) {
+      QueryResult r = runQuery(planner, octree, queries[k].first, queries[k].second, safe_dist, engine.second);
+      printf("%-6lu %-18s %12.2f %12.2f %10lu %8s\n", k, engine.first.c_str(), r.time_ms, r.path_length, r.n_waypoints, r.goal_reached ? "yes" : "no");
+      time_sum += r.time_ms;
+      length_sum += r.path_length;
+      n_reached += r.goal_reached;
+    }
+    printf("%-6s %-18s %12.2f %12.2f %10s %5d/%lu\n", "mean", engine.first.c_str(), time_sum / queries.size(), length_sum / queries.size(), "-", n_reached,
+           queries.size());
+  }
+
+  return 0;
+}
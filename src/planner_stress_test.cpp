@@ -0,0 +1,281 @@
+/* Load test of planning concurrent with map updates.
+ *
+ * Usage: planner_stress_test <map.bt> <queries.txt> [duration] [map_rate] [path_rate] [validity_rate] [multi_goal_rate] [safe_dist] [planning_timeout]
+ *
+ * The queries file has the format of planner_benchmark, "sx sy sz gx gy gz" per line. Rates are in Hz, zero disables the thread.
+ * The mapping thread integrates batches of cells of the loaded map into a working octree at map_rate and publishes a copy of it as the new planning map,
+ * the points of the batch are also inserted into the sensor overlays of the planners. Query threads, each with its own planner, run findPath(),
+ * firstUnfeasibleNodeInPath() and multi-waypoint getNodePath() on the latest published map at their rates. Throughput, p50/p99 latency and resident memory are
+ * printed every second, latency histograms over the whole run at the end.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <mrs_subt_planning_lib/astar_planner.h>
+
+using namespace mrs_subt_planning;
+
+typedef std::chrono::steady_clock Clock;
+
+struct SharedMap
+{
+  std::mutex                       mutex;
+  std::shared_ptr<octomap::OcTree> octree;
+  uint64_t                         revision = 0;
+
+  std::pair<std::shared_ptr<octomap::OcTree>, uint64_t> get() {
+    std::scoped_lock lock(mutex);
+    return std::make_pair(octree, revision);
+  }
+};
+
+struct QueryStats
+{
+  std::string           name;
+  double                rate = 0.0;  // [Hz], target rate
+  LatencyHistogram      interval;    // reset after every report
+  LatencyHistogram      total;
+  std::atomic<uint64_t> n_empty{0};  // queries without result
+};
+
+std::atomic<bool> running{true};
+
+double residentMemoryMB() {
+  std::ifstream statm("/proc/self/statm");
+  size_t        size = 0, resident = 0;
+  statm >> size >> resident;
+  return resident * double(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+}
+
+// metric bounds of a copied octree are computed lazily by the first getMetricMin/Max() call, must be done before the tree is shared by the query threads
+void cacheMetricBounds(octomap::OcTree& octree) {
+  double x, y, z;
+  octree.getMetricMin(x, y, z);
+  octree.getMetricMax(x, y, z);
+}
+
+// calls query at the given rate until stopped, a query taking longer than the period delays the next one
+template <typename Query>
+void runAtRate(QueryStats& stats, Query query) {
+  auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / stats.rate));
+  auto next   = Clock::now();
+  while (running) {
+    auto t_start = Clock::now();
+    bool success = query();
+    auto latency = std::chrono::duration<double>(Clock::now() - t_start).count();
+    stats.interval.record(latency);
+    stats.total.record(latency);
+    stats.n_empty += !success;
+    next = std::max(next + period, Clock::now());
+    std::this_thread::sleep_until(next);
+  }
+}
+
+int main(int argc, char** argv) {
+
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <map.bt> <queries.txt> [duration] [map_rate] [path_rate] [validity_rate] [multi_goal_rate] [safe_dist] [planning_timeout]" << std::endl;
+    return 1;
+  }
+
+  ros::Time::init();
+
+  double duration         = argc > 3 ? std::stod(argv[3]) : 30.0;
+  double map_rate         = argc > 4 ? std::stod(argv[4]) : 10.0;
+  double path_rate        = argc > 5 ? std::stod(argv[5]) : 2.0;
+  double validity_rate    = argc > 6 ? std::stod(argv[6]) : 10.0;
+  double multi_goal_rate  = argc > 7 ? std::stod(argv[7]) : 0.5;
+  double safe_dist        = argc > 8 ? std::stod(argv[8]) : 1.0;
+  double planning_timeout = argc > 9 ? std::stod(argv[9]) : 2.0;
+
+  std::shared_ptr<octomap::OcTree> loaded_octree = std::make_shared<octomap::OcTree>(std::string(argv[1]));
+  double                           min_x, min_y, min_z, max_x, max_y, max_z;
+  loaded_octree->getMetricMin(min_x, min_y, min_z);
+  loaded_octree->getMetricMax(max_x, max_y, max_z);
+
+  std::vector<std::pair<octomap::point3d, octomap::point3d>> queries;
+  std::ifstream                                              queries_file(argv[2]);
+  std::string                                                line;
+  while (std::getline(queries_file, line)) {
+    std::istringstream ss(line);
+    double             sx, sy, sz, gx, gy, gz;
+    if (ss >> sx >> sy >> sz >> gx >> gy >> gz) {
+      queries.push_back(std::make_pair(octomap::point3d(sx, sy, sz), octomap::point3d(gx, gy, gz)));
+    }
+  }
+
+  if (queries.empty()) {
+    std::cerr << "No queries loaded from " << argv[2] << std::endl;
+    return 1;
+  }
+
+  // cells of the loaded map integrated again by the mapping thread
+  std::vector<std::pair<octomap::point3d, bool>> map_cells;
+  for (auto it = loaded_octree->begin_leafs(), end = loaded_octree->end_leafs(); it != end; ++it) {
+    map_cells.push_back(std::make_pair(it.getCoordinate(), loaded_octree->isNodeOccupied(*it)));
+  }
+
+  SharedMap shared_map;
+  shared_map.octree = std::make_shared<octomap::OcTree>(*loaded_octree);
+  cacheMetricBounds(*shared_map.octree);
+
+  auto initPlanner = [&](AstarPlanner& planner) { planner.initialize(true, planning_timeout, safe_dist, safe_dist, min_z, max_z, false, nullptr); };
+
+  AstarPlanner path_planner, validity_planner, multi_goal_planner;
+  initPlanner(path_planner);
+  initPlanner(validity_planner);
+  initPlanner(multi_goal_planner);
+  std::vector<AstarPlanner*> planners = {&path_planner, &validity_planner, &multi_goal_planner};
+
+  QueryStats path_stats, validity_stats, multi_goal_stats;
+  path_stats.name       = "find_path";
+  path_stats.rate       = path_rate;
+  validity_stats.name   = "validity_check";
+  validity_stats.rate   = validity_rate;
+  multi_goal_stats.name = "multi_goal";
+  multi_goal_stats.rate = multi_goal_rate;
+  std::vector<QueryStats*> all_stats = {&path_stats, &validity_stats, &multi_goal_stats};
+
+  std::atomic<uint64_t>    n_map_updates{0};
+  std::vector<std::thread> threads;
+
+  /* mapping thread //{ */
+  if (map_rate > 0.0) {
+    threads.push_back(std::thread([&]() {
+      std::shared_ptr<octomap::OcTree>      working_octree = std::make_shared<octomap::OcTree>(*loaded_octree);
+      std::mt19937                          generator(0);
+      std::uniform_int_distribution<size_t> cell_distribution(0, map_cells.size() - 1);
+      auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / map_rate));
+      auto next   = Clock::now();
+      while (running) {
+        std::vector<pcl::PointXYZ> scan_points;
+        for (int k = 0; k < 1000 && !map_cells.empty(); k++) {
+          const auto& cell = map_cells[cell_distribution(generator)];
+          working_octree->updateNode(cell.first, cell.second);
+          if (cell.second) {
+            scan_points.push_back(pcl::PointXYZ(cell.first.x(), cell.first.y(), cell.first.z()));
+          }
+        }
+        std::shared_ptr<octomap::OcTree> published = std::make_shared<octomap::OcTree>(*working_octree);
+        cacheMetricBounds(*published);
+        {
+          std::scoped_lock lock(shared_map.mutex);
+          shared_map.octree = published;
+          shared_map.revision++;
+        }
+        for (auto planner : planners) {
+          planner->insertSensorPoints(scan_points, ros::Time::now());
+        }
+        n_map_updates++;
+        next = std::max(next + period, Clock::now());
+        std::this_thread::sleep_until(next);
+      }
+    }));
+  }
+  //}
+
+  /* findPath() thread //{ */
+  if (path_rate > 0.0) {
+    threads.push_back(std::thread([&]() {
+      size_t query_idx = 0;
+      runAtRate(path_stats, [&]() {
+        auto map   = shared_map.get();
+        auto query = queries[query_idx++ % queries.size()];
+        path_planner.setMapRevision(map.second);
+        auto path = path_planner.findPath(query.first, query.second, map.first, false, true, 0.0, 0.0, safe_dist, 5, false, 0.3, 5, 1.0, true, 0.3);
+        return !path.first.empty();
+      });
+    }));
+  }
+  //}
+
+  /* firstUnfeasibleNodeInPath() thread //{ */
+  if (validity_rate > 0.0) {
+    threads.push_back(std::thread([&]() {
+      // the checked path is planned once on the initial map, it is then checked against the latest map as during path following
+      auto map  = shared_map.get();
+      auto path = validity_planner.findPath(queries[0].first, queries[0].second, map.first, false, true, 0.0, 0.0, safe_dist, 5, false, 0.3, 5, 1.0, true, 0.3);
+      std::vector<octomap::OcTreeKey>   key_path;
+      std::vector<geometry_msgs::Point> pose_array;  // keys stored as coordinates, see getKeyVectorFromCoordinates()
+      for (auto& p : path.first) {
+        key_path.push_back(map.first->coordToKey(p));
+        geometry_msgs::Point key_point;
+        key_point.x = key_path.back().k[0];
+        key_point.y = key_path.back().k[1];
+        key_point.z = key_path.back().k[2];
+        pose_array.push_back(key_point);
+      }
+      if (key_path.empty()) {
+        std::cerr << "Path of the first query not found, validity checks disabled." << std::endl;
+        return;
+      }
+      size_t pose_idx = 0;
+      runAtRate(validity_stats, [&]() {
+        validity_planner.setPlanningOctree(shared_map.get().first);
+        octomap::point3d current_pose = path.first[pose_idx++ % path.first.size()];
+        auto             result       = validity_planner.firstUnfeasibleNodeInPath(key_path, pose_array, 20, current_pose, safe_dist, 0.5 * safe_dist);
+        return result.first < 0;  // counted as empty if the path became unsafe
+      });
+    }));
+  }
+  //}
+
+  /* multi-waypoint getNodePath() thread //{ */
+  if (multi_goal_rate > 0.0) {
+    threads.push_back(std::thread([&]() {
+      size_t query_idx = 0;
+      runAtRate(multi_goal_stats, [&]() {
+        auto                          map = shared_map.get();
+        std::vector<octomap::point3d> waypoints;
+        waypoints.push_back(queries[query_idx % queries.size()].first);
+        waypoints.push_back(queries[query_idx % queries.size()].second);
+        waypoints.push_back(queries[(query_idx + 1) % queries.size()].second);
+        query_idx++;
+        multi_goal_planner.setMapRevision(map.second);
+        return !multi_goal_planner.getNodePath(waypoints, map.first).empty();
+      });
+    }));
+  }
+  //}
+
+  printf("%8s %-16s %10s %10s %10s %8s %12s %10s\n", "time [s]", "query", "rate [Hz]", "p50 [ms]", "p99 [ms]", "empty", "map updates", "rss [MB]");
+  auto start_time  = Clock::now();
+  auto last_report = start_time;
+  while (std::chrono::duration<double>(Clock::now() - start_time).count() < duration) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto   now      = Clock::now();
+    double elapsed  = std::chrono::duration<double>(now - start_time).count();
+    double interval = std::chrono::duration<double>(now - last_report).count();
+    double rss      = residentMemoryMB();
+    last_report     = now;
+    for (auto stats : all_stats) {
+      if (stats->rate <= 0.0) {
+        continue;
+      }
+      printf("%8.1f %-16s %10.2f %10.2f %10.2f %8lu %12lu %10.1f\n", elapsed, stats->name.c_str(), stats->interval.getCount() / interval,
+             stats->interval.getPercentile(50.0) * 1000.0, stats->interval.getPercentile(99.0) * 1000.0, uint64_t(stats->n_empty), uint64_t(n_map_updates),
+             rss);
+      stats->interval.reset();
+    }
+  }
+
+  running = false;
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  double total_time = std::chrono::duration<double>(Clock::now() - start_time).count();
+  for (auto stats : all_stats) {
+    if (stats->rate > 0.0) {
+      printf("%-16s throughput %.2f Hz, %s\n", stats->name.c_str(), stats->total.getCount() / total_time, stats->total.toString().c_str());
+    }
+  }
+  printf("map updates %.2f Hz, final rss %.1f MB\n", n_map_updates / total_time, residentMemoryMB());
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+#include "mrs_subt_planning_lib/planning_pipeline.h"
+
+using namespace std;
+using namespace mrs_subt_planning;
+
+PlanningPipeline::PlanningPipeline(size_t queue_size) : prep_queue_(queue_size), search_queue_(queue_size), postprocess_queue_(queue_size) {
+  next_id_          = 1;
+  dropped_requests_ = 0;
+  initialized_      = false;
+}
+
+PlanningPipeline::~PlanningPipeline() {
+  stop();
+}
+
+/* initialize() //{ */
+void PlanningPipeline::initialize(bool enable_planning_to_unreachable_goal, double planning_timeout, double safe_dist, double clearing_dist,
+                                  double min_altitude, double max_altitude, std::function<void(const PlanningResult&)> result_callback) {
+  if (initialized_) {
+    ROS_WARN("[PlanningPipeline]: Pipeline already initialized.");
+    return;
+  }
+
+  prep_planner_.initialize(enable_planning_to_unreachable_goal, planning_timeout, safe_dist, clearing_dist, min_altitude, max_altitude, false, nullptr);
+  search_planner_.initialize(enable_planning_to_unreachable_goal, planning_timeout, safe_dist, clearing_dist, min_altitude, max_altitude, false, nullptr);
+  postprocess_planner_.initialize(enable_planning_to_unreachable_goal, planning_timeout, safe_dist, clearing_dist, min_altitude, max_altitude, false, nullptr);
+  result_callback_ = result_callback;
+
+  stage_threads_.push_back(std::thread(&PlanningPipeline::prepLoop, this));
+  stage_threads_.push_back(std::thread(&PlanningPipeline::searchLoop, this));
+  stage_threads_.push_back(std::thread(&PlanningPipeline::postprocessLoop, this));
+  initialized_ = true;
+  ROS_INFO("[PlanningPipeline]: Planning pipeline initialized.");
+}
+//}
+
+/* submit() //{ */
+uint64_t PlanningPipeline::submit(PlanningRequest request) {
+  request.id = next_id_++;
+  if (!prep_queue_.push(std::make_pair(request, ros::Time::now()))) {
+    dropped_requests_++;
+    ROS_WARN("[PlanningPipeline]: Map preparation queue full, oldest request dropped.");
+  }
+  return request.id;
+}
+//}
+
+/* stop() //{ */
+void PlanningPipeline::stop() {
+  prep_queue_.close();
+  search_queue_.close();
+  postprocess_queue_.close();
+  for (auto& t : stage_threads_) {
+    t.join();
+  }
+  stage_threads_.clear();
+}
+//}
+
+/* getNumberOfDroppedRequests() //{ */
+uint64_t PlanningPipeline::getNumberOfDroppedRequests() {
+  return dropped_requests_;
+}
+//}
+
+/* prepLoop() //{ */
+void PlanningPipeline::prepLoop() {
+  std::pair<PlanningRequest, ros::Time> item;
+  while (prep_queue_.pop(item)) {
+    if (isStale(item.first, "map preparation")) {
+      continue;
+    }
+    PreparedRequest prepared;
+    prepared.request         = item.first;
+    prepared.submission_time = item.second;
+    prepared.prepared_map    = prep_planner_.getPreparedMap(item.first.planning_octree);  // new obstacle index for every request
+    if (!search_queue_.push(prepared)) {
+      dropped_requests_++;
+      ROS_WARN("[PlanningPipeline]: Search queue full, oldest request dropped.");
+    }
+  }
+}
+//}
+
+/* searchLoop() //{ */
+void PlanningPipeline::searchLoop() {
+  PreparedRequest item;
+  while (search_queue_.pop(item)) {
+    if (isStale(item.request, "search")) {
+      continue;
+    }
+    SearchedRequest searched;
+    searched.request         = item.request;
+    searched.submission_time = item.submission_time;
+    searched.node_path       = search_planner_.getNodePath(item.request.start, item.request.goal, item.request.planning_octree, item.prepared_map);
+    if (!postprocess_queue_.push(searched)) {
+      dropped_requests_++;
+      ROS_WARN("[PlanningPipeline]: Postprocessing queue full, oldest request dropped.");
+    }
+  }
+}
+//}
+
+/* postprocessLoop() //{ */
+void PlanningPipeline::postprocessLoop() {
+  SearchedRequest item;
+  while (postprocess_queue_.pop(item)) {
+    if (isStale(item.request, "postprocessing")) {
+      continue;
+    }
+    const PlanningRequest& r = item.request;
+    PlanningResult         result;
+    result.id        = r.id;
+    result.waypoints = postprocess_planner_.postprocessPath(item.node_path, r.planning_octree, r.make_path_straight, r.apply_postprocessing,
+                                                            r.postprocessing_safe_dist, r.postprocessing_max_iterations,
+                                                            r.postprocessing_horizontal_neighbors_only, r.postprocessing_z_tolerance, r.shortening_window_size,
+                                                            r.shortening_dist, r.apply_pruning, r.pruning_dist);
+    result.latency   = (ros::Time::now() - item.submission_time).toSec();
+    if (result_callback_) {
+      result_callback_(result);
+    }
+  }
+}
+//}
+
+/* isStale() //{ */
+bool PlanningPipeline::isStale(const PlanningRequest& request, const std::string& stage) {
+  if (!request.deadline.isZero() && ros::Time::now() > request.deadline) {
+    dropped_requests_++;
+    ROS_WARN("[PlanningPipeline]: Request %lu missed its deadline, dropped before %s.", request.id, stage.c_str());
+    return true;
+  }
+  return false;
+}
+//}
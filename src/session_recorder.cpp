@@ -0,0 +1,256 @@
+#include <ros/ros.h>
+#include <sstream>
+#include "mrs_subt_planning_lib/session_recorder.h"
+
+using namespace mrs_subt_planning;
+
+namespace
+{
+
+const std::string SESSION_LOG_MAGIC = "MRSSESS3";  // format version in the last character
+
+// values are stored in the byte order of the recording machine
+template <typename T>
+void field(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void field(std::istream& in, T& value) {
+  in.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+void field(std::ostream& out, const octomap::point3d& p) {
+  field(out, p.x());
+  field(out, p.y());
+  field(out, p.z());
+}
+
+void field(std::istream& in, octomap::point3d& p) {
+  field(in, p.x());
+  field(in, p.y());
+  field(in, p.z());
+}
+
+void field(std::ostream& out, const std::vector<double>& values) {
+  uint32_t size = values.size();
+  field(out, size);
+  for (const double& v : values) {
+    field(out, v);
+  }
+}
+
+void field(std::istream& in, std::vector<double>& values) {
+  uint32_t size = 0;
+  field(in, size);
+  if (!in || size > 1024) {  // truncated or corrupted record
+    in.setstate(std::ios::failbit);
+    return;
+  }
+  values.resize(size);
+  for (double& v : values) {
+    field(in, v);
+  }
+}
+
+// planner configuration, also used for the comparison of records
+template <typename Stream, typename Record>
+void configFields(Stream& s, Record& r) {
+  field(s, r.enable_planning_to_unreachable_goal);
+  field(s, r.planning_timeout);
+  field(s, r.safe_dist);
+  field(s, r.clearing_dist);
+  field(s, r.min_altitude);
+  field(s, r.max_altitude);
+  field(s, r.break_at_timeout);
+  field(s, r.astar_admissibility);
+  field(s, r.lazy_collision_checking);
+  field(s, r.vertical_oscillation_penalty);
+  field(s, r.obstacle_decimation_voxel_size);
+  field(s, r.obstacle_decimation_corridor_width);
+  field(s, r.unknown_space_traversal);
+  field(s, r.unknown_cost_factor);
+  field(s, r.search_memory_budget);
+  field(s, r.search_memory_max_admissibility);
+  field(s, r.rrt_step_size);
+  field(s, r.rrt_goal_bias);
+  field(s, r.rrt_max_iterations);
+  field(s, r.lattice_straight_length);
+  field(s, r.lattice_goal_tolerance);
+  field(s, r.layer_heights);
+  field(s, r.layered_max_ground_dist);
+  field(s, r.corridor_generation);
+  field(s, r.corridor_max_box_size);
+  field(s, r.corridor_obstacle_margin);
+}
+
+// single list of the fields for both writing and reading
+template <typename Stream, typename Record>
+void recordFields(Stream& s, Record& r) {
+  field(s, r.stamp);
+  configFields(s, r);
+  field(s, r.start);
+  field(s, r.goal);
+  field(s, r.make_path_straight);
+  field(s, r.apply_postprocessing);
+  field(s, r.planning_bbx_size_h);
+  field(s, r.planning_bbx_size_v);
+  field(s, r.postprocessing_safe_dist);
+  field(s, r.postprocessing_max_iterations);
+  field(s, r.postprocessing_horizontal_neighbors_only);
+  field(s, r.postprocessing_z_tolerance);
+  field(s, r.shortening_window_size);
+  field(s, r.shortening_dist);
+  field(s, r.apply_pruning);
+  field(s, r.pruning_dist);
+  field(s, r.ignore_unknown_cells_near_start);
+  field(s, r.box_size_for_unknown_cells_replacement);
+  field(s, r.cost_upper_bound);
+  field(s, r.planning_engine);
+  field(s, r.latency);
+  field(s, r.n_waypoints);
+  field(s, r.path_length);
+}
+
+}  // namespace
+
+/* SessionRecord::hasSameConfig() //{ */
+bool SessionRecord::hasSameConfig(const SessionRecord& other) const {
+  std::ostringstream a, b;
+  configFields(a, *this);
+  configFields(b, other);
+  return a.str() == b.str();
+}
+//}
+
+SessionRecorder::SessionRecorder() {
+  request_pending_     = false;
+  last_map_revision_   = 0;
+  n_recorded_requests_ = 0;
+}
+
+/* open() //{ */
+bool SessionRecorder::open(const std::string& filename) {
+  close();
+  file_.open(filename, std::ios::binary | std::ios::trunc);
+  if (!file_.is_open()) {
+    ROS_ERROR("[SessionRecorder]: Cannot open session log %s for writing.", filename.c_str());
+    return false;
+  }
+  file_.write(SESSION_LOG_MAGIC.data(), SESSION_LOG_MAGIC.size());
+  last_octree_.reset();
+  request_pending_     = false;
+  n_recorded_requests_ = 0;
+  ROS_INFO("[SessionRecorder]: Recording planning session to %s.", filename.c_str());
+  return true;
+}
+//}
+
+/* close() //{ */
+void SessionRecorder::close() {
+  if (file_.is_open()) {
+    file_.close();
+    ROS_INFO("[SessionRecorder]: Session log closed after %lu requests.", n_recorded_requests_);
+  }
+  request_pending_ = false;
+}
+//}
+
+/* isOpen() //{ */
+bool SessionRecorder::isOpen() {
+  return file_.is_open();
+}
+//}
+
+/* beginRequest() //{ */
+void SessionRecorder::beginRequest(const SessionRecord& record, std::shared_ptr<octomap::OcTree> octree, const uint64_t map_revision) {
+  if (!isOpen()) {
+    return;
+  }
+  pending_record_ = record;
+  pending_record_.map_data.clear();
+  if (octree && (last_octree_.lock() != octree || last_map_revision_ != map_revision)) {
+    std::stringstream ss;
+    octree->writeBinaryConst(ss);  // the non-const variant would convert the octree to maximum likelihood
+    pending_record_.map_data = ss.str();
+    last_octree_             = octree;
+    last_map_revision_       = map_revision;
+  }
+  request_pending_ = true;
+}
+//}
+
+/* endRequest() //{ */
+void SessionRecorder::endRequest(const std::vector<octomap::point3d>& waypoints, const double latency) {
+  if (!isOpen() || !request_pending_) {
+    return;
+  }
+  pending_record_.latency     = latency;
+  pending_record_.n_waypoints = waypoints.size();
+  pending_record_.path_length = 0.0;
+  for (size_t k = 1; k < waypoints.size(); k++) {
+    pending_record_.path_length += waypoints[k].distance(waypoints[k - 1]);
+  }
+
+  recordFields(file_, pending_record_);
+  uint64_t map_size = pending_record_.map_data.size();
+  field(file_, map_size);
+  file_.write(pending_record_.map_data.data(), map_size);
+  file_.flush();  // keep the log readable if the process is killed during the mission
+  request_pending_ = false;
+  n_recorded_requests_++;
+}
+//}
+
+/* getNumberOfRecordedRequests() //{ */
+size_t SessionRecorder::getNumberOfRecordedRequests() {
+  return n_recorded_requests_;
+}
+//}
+
+/* SessionReader::open() //{ */
+bool SessionReader::open(const std::string& filename) {
+  file_.open(filename, std::ios::binary);
+  if (!file_.is_open()) {
+    ROS_ERROR("[SessionReader]: Cannot open session log %s.", filename.c_str());
+    return false;
+  }
+  std::string magic(SESSION_LOG_MAGIC.size(), '\0');
+  file_.read(&magic[0], magic.size());
+  if (!file_ || magic != SESSION_LOG_MAGIC) {
+    ROS_ERROR("[SessionReader]: File %s is not a session log of a supported version.", filename.c_str());
+    file_.close();
+    return false;
+  }
+  return true;
+}
+//}
+
+/* SessionReader::readNext() //{ */
+bool SessionReader::readNext(SessionRecord& record, std::shared_ptr<octomap::OcTree>& octree) {
+  if (!file_.is_open()) {
+    return false;
+  }
+  recordFields(file_, record);
+  uint64_t map_size = 0;
+  field(file_, map_size);
+  if (!file_) {
+    return false;
+  }
+  record.map_data.resize(map_size);
+  file_.read(&record.map_data[0], map_size);
+  if (!file_) {
+    ROS_WARN("[SessionReader]: Truncated record at the end of the session log.");
+    return false;
+  }
+  if (map_size > 0) {
+    std::stringstream ss(record.map_data);
+    octree = std::make_shared<octomap::OcTree>(0.1);  // resolution is read from the stream
+    if (!octree->readBinary(ss)) {
+      ROS_WARN("[SessionReader]: Cannot read map snapshot from the session log.");
+      return false;
+    }
+  }
+  return true;
+}
+//}
@@ -0,0 +1,109 @@
+/* Replay of planning sessions recorded by AstarPlanner::startSessionRecording().
+ *
+ * Usage: session_replay <session.log> [time_scale]
+ *
+ * Every recorded findPath() request is planned again on the recorded map snapshot with the recorded parameters and planner configuration.
+ * The ROS clock is virtual: it is set to the stamp of each request and advances with the wall time of the replay multiplied by time_scale (default 1.0)
+ * during planning, so planning timeouts trigger as in flight. Use time_scale > 1 if the replaying machine is faster than the onboard computer.
+ * The recorded and replayed latency, number of waypoints and path length are printed for every request.
+ */
+
+#include <chrono>
+#include <thread>
+#include <mrs_subt_planning_lib/astar_planner.h>
+
+using namespace mrs_subt_planning;
+
+void applyConfig(AstarPlanner& planner, const SessionRecord& record) {
+  planner.initialize(record.enable_planning_to_unreachable_goal, record.planning_timeout, record.safe_dist, record.clearing_dist, record.min_altitude,
+                     record.max_altitude, false, nullptr, record.break_at_timeout);
+  planner.setAstarAdmissibility(record.astar_admissibility);
+  planner.setLazyCollisionChecking(record.lazy_collision_checking);
+  planner.setVerticalOscillationPenalty(record.vertical_oscillation_penalty);
+  planner.setObstacleDecimation(record.obstacle_decimation_voxel_size, record.obstacle_decimation_corridor_width);
+  planner.setUnknownSpaceTraversal(record.unknown_space_traversal, record.unknown_cost_factor);
+  planner.setSearchMemoryBudget(record.search_memory_budget, record.search_memory_max_admissibility);
+  planner.setSamplingPlannerParams(record.rrt_step_size, record.rrt_goal_bias, record.rrt_max_iterations);
+  planner.setLatticeParams(record.lattice_straight_length, record.lattice_goal_tolerance);
+  planner.setLayeredPlanningParams(record.layer_heights, record.layered_max_ground_dist);
+  planner.setCorridorGeneration(record.corridor_generation, record.corridor_max_box_size, record.corridor_obstacle_margin);
+}
+
+int main(int argc, char** argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <session.log> [time_scale]" << std::endl;
+    return 1;
+  }
+
+  ros::Time::init();
+
+  double time_scale = argc > 2 ? std::stod(argv[2]) : 1.0;
+
+  SessionReader reader;
+  if (!reader.open(argv[1])) {
+    return 1;
+  }
+
+  AstarPlanner                     planner;
+  SessionRecord                    config;
+  SessionRecord                    record;
+  std::shared_ptr<octomap::OcTree> octree;
+  LatencyHistogram                 recorded_latency;
+  LatencyHistogram                 replayed_latency;
+  bool                             initialized = false;
+  size_t                           n_requests  = 0;
+  size_t                           n_differing = 0;
+
+  printf("%-8s %14s %14s %10s %10s %12s %12s\n", "request", "recorded [ms]", "replayed [ms]", "rec. wps", "rep. wps", "rec. len [m]", "rep. len [m]");
+  while (reader.readNext(record, octree)) {
+    if (!octree) {
+      std::cerr << "Request " << n_requests << " has no map snapshot, skipped." << std::endl;
+      n_requests++;
+      continue;
+    }
+
+    if (!initialized || !config.hasSameConfig(record)) {
+      applyConfig(planner, record);
+      config      = record;
+      initialized = true;
+    }
+
+    ros::Time::setNow(ros::Time(record.stamp));
+    auto              t_start = std::chrono::steady_clock::now();
+    std::atomic<bool> planning{true};
+    std::thread       clock_thread([&]() {
+      while (planning) {
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+        ros::Time::setNow(ros::Time(record.stamp + elapsed * time_scale));
+      }
+    });
+    auto path    = planner.findPath(record.start, record.goal, octree, record.make_path_straight, record.apply_postprocessing, record.planning_bbx_size_h,
+                                    record.planning_bbx_size_v, record.postprocessing_safe_dist, record.postprocessing_max_iterations,
+                                    record.postprocessing_horizontal_neighbors_only, record.postprocessing_z_tolerance, record.shortening_window_size,
+                                    record.shortening_dist, record.apply_pruning, record.pruning_dist, record.ignore_unknown_cells_near_start,
+                                    record.box_size_for_unknown_cells_replacement, record.cost_upper_bound, PlanningEngine(record.planning_engine));
+    double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+    planning       = false;
+    clock_thread.join();
+
+    double path_length = 0.0;
+    for (size_t k = 1; k < path.first.size(); k++) {
+      path_length += path.first[k].distance(path.first[k - 1]);
+    }
+    recorded_latency.record(record.latency);
+    replayed_latency.record(latency);
+    n_differing += path.first.size() != record.n_waypoints || fabs(path_length - record.path_length) > 1e-3;
+
+    printf("%-8lu %14.2f %14.2f %10u %10lu %12.2f %12.2f\n", n_requests, record.latency * 1000.0, latency * 1000.0, record.n_waypoints, path.first.size(),
+           record.path_length, path_length);
+    n_requests++;
+  }
+
+  printf("recorded: %s\n", recorded_latency.toString().c_str());
+  printf("replayed: %s\n", replayed_latency.toString().c_str());
+  printf("%lu of %lu requests produced a different path than recorded\n", n_differing, n_requests);
+
+  return 0;
+}
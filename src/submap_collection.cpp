@@ -0,0 +1,132 @@
+#include <ros/ros.h>
+#include "mrs_subt_planning_lib/submap_collection.h"
+
+using namespace mrs_subt_planning;
+
+SubmapCollection::SubmapCollection() {
+}
+
+/* addSubmap() //{ */
+void SubmapCollection::addSubmap(std::shared_ptr<octomap::OcTree> octree, const Eigen::Isometry3d& pose) {
+  Submap submap;
+  submap.octree   = octree;
+  submap.pose     = pose;
+  submap.pose_inv = pose.inverse();
+
+  double min_x, min_y, min_z, max_x, max_y, max_z;
+  octree->getMetricMin(min_x, min_y, min_z);
+  octree->getMetricMax(max_x, max_y, max_z);
+  Eigen::Vector3d world_min = Eigen::Vector3d::Constant(DBL_MAX);
+  Eigen::Vector3d world_max = Eigen::Vector3d::Constant(-DBL_MAX);
+  for (int k = 0; k < 8; k++) {
+    Eigen::Vector3d corner(k & 1 ? max_x : min_x, k & 2 ? max_y : min_y, k & 4 ? max_z : min_z);
+    corner    = pose * corner;
+    world_min = world_min.cwiseMin(corner);
+    world_max = world_max.cwiseMax(corner);
+  }
+  submap.bbx_min = octomap::point3d(world_min.x(), world_min.y(), world_min.z());
+  submap.bbx_max = octomap::point3d(world_max.x(), world_max.y(), world_max.z());
+  submaps_.push_back(submap);
+}
+//}
+
+/* clear() //{ */
+void SubmapCollection::clear() {
+  submaps_.clear();
+}
+//}
+
+/* size() //{ */
+size_t SubmapCollection::size() {
+  return submaps_.size();
+}
+//}
+
+/* getResolution() //{ */
+double SubmapCollection::getResolution() {
+  return submaps_.empty() ? 0.0 : submaps_[0].octree->getResolution();
+}
+//}
+
+/* getCellState() //{ */
+CellState SubmapCollection::getCellState(const octomap::point3d& point) {
+  CellState state = CellState::UNKNOWN;
+  for (auto& submap : submaps_) {
+    if (!isInBounds(submap, point, 0.0)) {
+      continue;
+    }
+    Eigen::Vector3d      local = submap.pose_inv * Eigen::Vector3d(point.x(), point.y(), point.z());
+    octomap::OcTreeNode* node  = submap.octree->search(local.x(), local.y(), local.z());
+    if (node == NULL) {
+      continue;
+    }
+    if (submap.octree->isNodeOccupied(node)) {
+      return CellState::OCCUPIED;
+    }
+    state = CellState::FREE;
+  }
+  return state;
+}
+//}
+
+/* getDistanceFromNearestObstacle() //{ */
+double SubmapCollection::getDistanceFromNearestObstacle(const octomap::point3d& point, double max_dist) {
+  double        min_dist = FLT_MAX;
+  pcl::PointXYZ p(point.x(), point.y(), point.z());
+  for (auto& submap : submaps_) {
+    if (!isInBounds(submap, point, max_dist)) {  // obstacles of this submap are farther than max_dist
+      continue;
+    }
+    if (!submap.clearance_map) {
+      initClearanceMap(submap);
+    }
+    min_dist = fmin(min_dist, submap.clearance_map->getDistanceFromNearestPoint(p));
+  }
+  return min_dist <= max_dist ? min_dist : FLT_MAX;
+}
+//}
+
+/* getNumberOfClearanceMaps() //{ */
+int SubmapCollection::getNumberOfClearanceMaps() {
+  int n = 0;
+  for (auto& submap : submaps_) {
+    n += submap.clearance_map ? 1 : 0;
+  }
+  return n;
+}
+//}
+
+/* isInBounds() //{ */
+bool SubmapCollection::isInBounds(const Submap& submap, const octomap::point3d& point, double inflation) {
+  return point.x() >= submap.bbx_min.x() - inflation && point.x() <= submap.bbx_max.x() + inflation && point.y() >= submap.bbx_min.y() - inflation &&
+         point.y() <= submap.bbx_max.y() + inflation && point.z() >= submap.bbx_min.z() - inflation && point.z() <= submap.bbx_max.z() + inflation;
+}
+//}
+
+/* initClearanceMap() //{ */
+void SubmapCollection::initClearanceMap(Submap& submap) {
+  std::vector<pcl::PointXYZ> points;
+  double                     resolution = submap.octree->getResolution();
+  for (octomap::OcTree::leaf_iterator it = submap.octree->begin_leafs(), end = submap.octree->end_leafs(); it != end; ++it) {
+    if (!submap.octree->isNodeOccupied(*it)) {
+      continue;
+    }
+    // leafs with non-maximum depth are split into cells of the finest resolution
+    double           half_size = it.getSize() / 2.0;
+    octomap::point3d center    = it.getCoordinate();
+    for (double x = -half_size + resolution / 2.0; x < half_size; x += resolution) {
+      for (double y = -half_size + resolution / 2.0; y < half_size; y += resolution) {
+        for (double z = -half_size + resolution / 2.0; z < half_size; z += resolution) {
+          Eigen::Vector3d world = submap.pose * Eigen::Vector3d(center.x() + x, center.y() + y, center.z() + z);
+          points.push_back(pcl::PointXYZ(world.x(), world.y(), world.z()));
+        }
+      }
+    }
+  }
+  submap.clearance_map = std::make_shared<PCLMap>();
+  if (!points.empty()) {
+    submap.clearance_map->initKDTreeSearch(PCLMap::pclVectorToPointcloud(points));
+  }
+  ROS_INFO("[SubmapCollection]: Clearance map of submap with %lu obstacle points built.", points.size());
+}
+//}